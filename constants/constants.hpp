@@ -2,18 +2,22 @@
 #define CONSTANTS_HPP
 
 #include <array>
+#include <cstdint>
 
 #include "../core/hex.hpp"
 
-#define NB_ICONS 32
+// Color of an owner as read from the maps, converted to a renderer color by the frontend
+struct Color {
+    uint8_t r, g, b, a;
+};
 
-extern const std::array<std::string, NB_ICONS> iconNames;
-extern const std::vector<Hex> directions;
+inline bool operator==(const Color& lhs, const Color& rhs) {
+    return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
 
-const SDL_Color defaultColor = {0, 125, 0, SDL_ALPHA_OPAQUE}; // Dark green
-extern const std::map<char, SDL_Color> colorMap;
+extern const std::vector<Hex> directions;
 
-// Function to get the index of an icon name
-int getIconIndex(const std::string& name);
+const Color defaultColor = {0, 125, 0, 255}; // Dark green
+extern const std::map<char, Color> colorMap;
 
-#endif // CONSTANTS_HPP
\ No newline at end of file
+#endif // CONSTANTS_HPP
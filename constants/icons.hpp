@@ -0,0 +1,47 @@
+#ifndef ICON_IDS_HPP
+#define ICON_IDS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Icons of the game, in the order of iconNames
+enum class Icon : uint8_t {
+    Bandit,       BanditCamp,   Castle,     Coin,
+    Coins,        Deficit,      EmojiHappy, Face,
+    GoldTrophy,   Grave,        Hero,       Knight,
+    Pikeman,      SilverTrophy, Surplus,    Town,
+    Treasury,     Upkeep,       Villager,   Swords,
+    Next,         NextBright,   Quit,       Devil,
+    Forest,       Undo,         Replay,     InfoVillager,
+    InfoPikeman,  InfoKnight,   InfoHero,   InfoCastle,
+    None          // No icon (EntityKind::None)
+};
+constexpr int NB_ICONS = static_cast<int>(Icon::None);
+
+// Name of the file of each icon in the icons directory, without the .png extension
+constexpr std::array<const char*, NB_ICONS> iconNames = {
+    "bandit",         "bandit-camp",    "castle",      "coin",
+    "coins",          "deficit",        "emoji-happy", "face",
+    "gold-trophy",    "grave",          "hero",        "knight",
+    "pikeman",        "silver-trophy",  "surplus",     "town",
+    "treasury",       "upkeep",         "villager",    "swords",
+    "next",           "nextbright",     "quit",        "devil",
+    "forest",         "undo",           "replay",      "info-villager",
+    "info-pikeman",   "info-knight",    "info-hero",   "info-castle"
+};
+
+// Icon of a name ("villager", "next"...), Icon::None if unknown. For names read once (buttons),
+// rendering uses the icon ids.
+constexpr Icon iconFromName(std::string_view name) {
+    for (int i = 0; i < NB_ICONS; ++i) {
+        if (name == iconNames[i]) {
+            return static_cast<Icon>(i);
+        }
+    }
+    return Icon::None;
+}
+
+static_assert(iconFromName("info-castle") == Icon::InfoCastle, "iconNames must follow the order of Icon");
+
+#endif // ICON_IDS_HPP
@@ -2,12 +2,39 @@
 
 // --- HexagonalGrid Class Implementation ---
 
-HexagonalGrid::HexagonalGrid(double hexSize) : hexSize(hexSize), offsetX(0), offsetY(0), hoveredHex(nullptr) {}
+// Kind, owner and protection of an occupant packed in the value of a journal entry
+static int64_t packOccupant(const HexOccupant& occupant) {
+    return static_cast<int64_t>(occupant.kind) | (static_cast<int64_t>(occupant.owner) << 8) | (static_cast<int64_t>(occupant.protection) << 24);
+}
+
+static HexOccupant unpackOccupant(int64_t value, uint64_t entity) {
+    HexOccupant occupant;
+    occupant.kind = static_cast<EntityKind>(value & 0xFF);
+    occupant.owner = static_cast<OwnerId>((value >> 8) & 0xFFFF);
+    occupant.protection = static_cast<int8_t>(value >> 24);
+    occupant.entity = EntityHandle::fromBits(entity);
+    return occupant;
+}
+
+HexagonalGrid::HexagonalGrid(double hexSize) : gridWidth(0), gridHeight(0), ownersVersion(0), changedCellsVersion(0), hexSize(hexSize), offsetX(0), offsetY(0), hoveredHex(nullptr), journal(nullptr) {}
 
 
-void HexagonalGrid::generateFromASCII(const std::vector<std::string>& asciiMap, int windowWidth, int windowHeight) {
+void HexagonalGrid::generateFromASCII(const std::vector<std::string>& asciiMap) {
     hexes.clear();
-    hexColors.clear();
+
+    // Size the flat storage after the ASCII map (one cell per character)
+    gridHeight = static_cast<int>(asciiMap.size());
+    gridWidth = 0;
+    for (const auto& line : asciiMap) {
+        gridWidth = std::max(gridWidth, static_cast<int>(line.size()));
+    }
+    cellOwners.assign(static_cast<size_t>(gridWidth) * gridHeight, NEUTRAL_OWNER);
+    cellExists.assign(static_cast<size_t>(gridWidth) * gridHeight, false);
+    cellOccupants.assign(static_cast<size_t>(gridWidth) * gridHeight, HexOccupant());
+
+    // Every color character other than the default one is an owner, numbered in order of appearance
+    palette.assign(1, defaultColor);
+    std::map<char, OwnerId> ownerOfChar = {{'.', NEUTRAL_OWNER}};
 
     // Parse the ASCII map and generate hexes
     for (size_t row = 0; row < asciiMap.size(); ++row) {
@@ -22,12 +49,58 @@ void HexagonalGrid::generateFromASCII(const std::vector<std::string>& asciiMap,
                 Hex hex(q, r, s);
                 hexes.push_back(hex);
 
-                // Assign color based on character
-                hexColors[hex] = colorMap.at(c);
+                // Assign owner based on character
+                auto owner = ownerOfChar.find(c);
+                if (owner == ownerOfChar.end()) {
+                    owner = ownerOfChar.emplace(c, static_cast<OwnerId>(palette.size())).first;
+                    palette.push_back(colorMap.at(c));
+                }
+                size_t index = row * gridWidth + col;
+                cellExists[index] = true;
+                cellOwners[index] = owner->second;
             }
         }
     }
 
+    // Build the neighbor table once, neighbor walks then never look up hexes
+    neighborCells.assign(cellOwners.size() * NB_DIRECTIONS, -1);
+    for (const auto& hex : hexes) {
+        int index = cellIndex(hex);
+        for (int d = 0; d < NB_DIRECTIONS; ++d) {
+            neighborCells[index * NB_DIRECTIONS + d] = cellIndex(hex.add(directions[d]));
+        }
+    }
+
+    // No entity protects anything until the entities are placed
+    cellProtection.assign(cellOwners.size() * palette.size(), -1);
+
+    // Every neutral hex is free until the entities are placed
+    freeCells.clear();
+    freeCellPositions.assign(cellOwners.size(), -1);
+    for (size_t i = 0; i < cellOwners.size(); ++i) {
+        if (cellExists[i] && cellOwners[i] == NEUTRAL_OWNER) {
+            insertFreeCell(i, freeCells.size());
+        }
+    }
+
+    // Initialize the owner counters, every hex is checked at the first connectivity update
+    ownerCases.assign(palette.size(), 0);
+    dirtyCells.clear();
+    for (size_t i = 0; i < cellOwners.size(); ++i) {
+        if (cellExists[i]) {
+            ownerCases[cellOwners[i]]++;
+            dirtyCells.push_back(i);
+        }
+    }
+    ownersVersion++;
+    changedCells.clear();
+    changedCellsVersion = ownersVersion;
+}
+
+void HexagonalGrid::centerOn(int windowWidth, int windowHeight) {
+    offsetX = 0;
+    offsetY = 0;
+
     // Calculate the bounding box of the grid in pixel space
     double minX = std::numeric_limits<double>::max();
     double maxX = std::numeric_limits<double>::lowest();
@@ -87,72 +160,349 @@ Hex HexagonalGrid::pixelToHex(int x, int y, int cameraX, int cameraY) const {
     return Hex(rq, rr, rs);
 }
 
-bool HexagonalGrid::hexExists(const Hex& hex) const {
-    return hexColors.find(hex) != hexColors.end();
+// Margin around a view where a hex is still seen: half a hex with its outline, an entity jumping above its hex
+static double viewMargin(double hexSize) {
+    return hexSize + 1;
 }
 
-void HexagonalGrid::handleMouseClick(int mouseX, int mouseY, int cameraX, int cameraY) {
-    Hex clickedHex = pixelToHex(mouseX, mouseY, cameraX, cameraY);
+void HexagonalGrid::rowsInView(const GridView& view, int& firstRow, int& lastRow) const {
+    // The center of the hexes of a row is at y = 1.5 * hexSize * row + offsetY
+    double margin = viewMargin(hexSize);
+    double rowHeight = 1.5 * hexSize;
+    firstRow = std::max(0, static_cast<int>(std::ceil((view.y - margin - offsetY) / rowHeight)));
+    lastRow = std::min(gridHeight - 1, static_cast<int>(std::floor((view.y + view.height + margin - offsetY) / rowHeight)));
+}
 
-    // Check if the clicked hex is in the grid
-    if (hexColors.find(clickedHex) != hexColors.end()) {
-        hexColors[clickedHex] = {255, 0, 0, SDL_ALPHA_OPAQUE}; // Change color to red
-    }
+void HexagonalGrid::columnsInView(const GridView& view, int row, int& firstCol, int& lastCol) const {
+    // The center of the hex of a column is at x = sqrt(3) * hexSize * (col + 0.5 on odd rows) + offsetX
+    double margin = viewMargin(hexSize);
+    double colWidth = std::sqrt(3) * hexSize;
+    double shift = (row % 2) * 0.5;
+    firstCol = std::max(0, static_cast<int>(std::ceil((view.x - margin - offsetX) / colWidth - shift)));
+    lastCol = std::min(gridWidth - 1, static_cast<int>(std::floor((view.x + view.width + margin - offsetX) / colWidth - shift)));
 }
 
-void HexagonalGrid::draw(SDL_Renderer* renderer, int cameraX, int cameraY) const {
-    for (const auto& hex : hexes) {
-        Point center = hexToPixel(hex);
+bool HexagonalGrid::isInView(const Hex& hex, const GridView& view) const {
+    Point center = hexToPixel(hex);
+    double margin = viewMargin(hexSize);
+    return center.x >= view.x - margin && center.x <= view.x + view.width + margin
+        && center.y >= view.y - margin && center.y <= view.y + view.height + margin;
+}
 
-        // Get the color of the hex
-        SDL_Color color = hexColors.at(hex);
+int HexagonalGrid::cellIndex(const Hex& hex) const {
+    int index = storageIndex(hex);
+    return index != -1 && cellExists[index] ? index : -1;
+}
 
-        // Calculate the points of the hexagon
-        Sint16 xPoints[6];
-        Sint16 yPoints[6];
-        for (int i = 0; i < 6; ++i) {
-            double angle = 2 * M_PI / 6 * (i + 0.5); // Pointy-top hex
-            xPoints[i] = static_cast<Sint16>(center.x + hexSize * std::cos(angle)) - cameraX;
-            yPoints[i] = static_cast<Sint16>(center.y + hexSize * std::sin(angle)) - cameraY;
-        }
+int HexagonalGrid::storageIndex(const Hex& hex) const {
+    // Convert axial coordinates back to the offset (col, row) used by the ASCII map
+    int row = hex.getR();
+    if (row < 0 || row >= gridHeight) {
+        return -1;
+    }
+    int col = hex.getQ() + row / 2;
+    if (col < 0 || col >= gridWidth) {
+        return -1;
+    }
+    return row * gridWidth + col;
+}
 
-        // Fill the hexagon with the specified color
-        filledPolygonRGBA(renderer, xPoints, yPoints, 6, color.r, color.g, color.b, color.a);
+Hex HexagonalGrid::cellHex(int index) const {
+    int row = index / gridWidth;
+    int q = index % gridWidth - row / 2;
+    return Hex(q, row, -q - row);
+}
 
-        // Draw the outline of the hexagon
-        aapolygonRGBA(renderer, xPoints, yPoints, 6, 0, 0, 0, 255);
+OwnerId HexagonalGrid::cell(const Hex& hex) const {
+    int index = cellIndex(hex);
+    if (index == -1) {
+        throw std::out_of_range("Hex is not in the grid");
     }
+    return cellOwners[index];
+}
+
+Color HexagonalGrid::getHexColor(const Hex& hex) const {
+    OwnerId owner = cell(hex);
+    Color color = palette[owner & OWNER_MASK];
+
+    // Make the color darker if the hex is cut from its owner's towns
+    if (owner & DISCONNECTED_FLAG) {
+        color.r = color.r * 0.7;
+        color.g = color.g * 0.7;
+        color.b = color.b * 0.7;
+    }
+    return color;
+}
+
+OwnerId HexagonalGrid::getConnectedOwner(const Hex& hex) const {
+    OwnerId owner = cell(hex);
+    return (owner & DISCONNECTED_FLAG) ? NEUTRAL_OWNER : owner;
+}
+
+bool HexagonalGrid::isOwnedBy(const Hex& hex, OwnerId owner) const {
+    int index = cellIndex(hex);
+    return index != -1 && cellOwners[index] == owner;
 }
 
-void HexagonalGrid::setHexColor(const Hex& hex, const SDL_Color& color) {
+void HexagonalGrid::setOwner(const Hex& hex, OwnerId owner) {
     // Check if the hex exists in the grid
-    if (hexExists(hex)) {
-        hexColors[hex] = color;
+    int index = cellIndex(hex);
+    if (index != -1 && cellOwners[index] != owner) {
+        writeCell(index, owner);
+        addDirtyCell(index);
+    }
+}
+
+void HexagonalGrid::markDirty(const Hex& hex) {
+    int index = cellIndex(hex);
+    if (index != -1) {
+        addDirtyCell(index);
+    }
+}
+
+void HexagonalGrid::addDirtyCell(int index) {
+    if (journal) {
+        journal->record({JournalField::DirtyCellAdded, NEUTRAL_OWNER, index, 0, 0});
+    }
+    dirtyCells.push_back(index);
+}
+
+void HexagonalGrid::clearDirtyCells() {
+    if (journal) {
+        // Recorded from the back, undoing the entries pushes the cells again in the same order
+        for (auto it = dirtyCells.rbegin(); it != dirtyCells.rend(); ++it) {
+            journal->record({JournalField::DirtyCellRemoved, NEUTRAL_OWNER, *it, 0, 0});
+        }
+    }
+    dirtyCells.clear();
+}
+
+void HexagonalGrid::setDisconnected(const Hex& hex, bool disconnected) {
+    int index = cellIndex(hex);
+    if (index != -1) {
+        if (disconnected) {
+            writeCell(index, cellOwners[index] | DISCONNECTED_FLAG);
+        } else {
+            writeCell(index, cellOwners[index] & OWNER_MASK);
+        }
     }
 }
 
-bool HexagonalGrid::hasNeighborWithColor(const Hex& hex, const SDL_Color& color) const {
+bool HexagonalGrid::hasNeighborOwnedBy(const Hex& hex, OwnerId owner) const {
+    int index = cellIndex(hex);
+    if (index == -1) {
+        return false;
+    }
+
     // Check each neighbor
-    for (const auto& direction : directions) {
-        Hex neighbor = hex.add(direction);
-        auto it = hexColors.find(neighbor);
-        if (it != hexColors.end()) {
-            const SDL_Color& neighborColor = it->second;
-            if (neighborColor == color) {
-                return true;
-            }
+    const int* neighbors = cellNeighbors(index);
+    for (int d = 0; d < NB_DIRECTIONS; ++d) {
+        if (neighbors[d] != -1 && cellOwners[neighbors[d]] == owner) {
+            return true;
         }
     }
 
     return false;
 }
 
-int HexagonalGrid::getNbCasesColor(const SDL_Color& color) const {
+void HexagonalGrid::writeCell(int index, OwnerId value) {
+    OwnerId previous = cellOwners[index];
+    if (previous == value) {
+        return;
+    }
+    if (journal) {
+        journal->record({JournalField::CellOwner, NEUTRAL_OWNER, index, previous, 0});
+    }
+    assignCell(index, value);
+    updateFreeCell(index);
+}
+
+void HexagonalGrid::assignCell(int index, OwnerId value) {
+    OwnerId previous = cellOwners[index];
+
+    // Disconnected hexes are not counted in their owner's territory
+    if (!(previous & DISCONNECTED_FLAG)) {
+        ownerCases[previous]--;
+    }
+    if (!(value & DISCONNECTED_FLAG)) {
+        ownerCases[value]++;
+    }
+    cellOwners[index] = value;
+
+    // Past a change per cell, repainting every hex costs less than going through the list
+    if (changedCells.size() >= cellOwners.size()) {
+        changedCells.clear();
+        changedCellsVersion = ownersVersion;
+    }
+    changedCells.push_back(index);
+    ownersVersion++;
+}
+
+int HexagonalGrid::getNbCasesOwnedBy(OwnerId owner) const {
+    if (owner >= ownerCases.size()) {
+        return 0;
+    }
+#ifdef KONKR_DEBUG
+    // Debug builds check the counter against a full recount
+    assert(ownerCases[owner] == countCasesOwnedBy(owner));
+#endif
+    return ownerCases[owner];
+}
+
+int HexagonalGrid::countCasesOwnedBy(OwnerId owner) const {
     int count = 0;
-    for (const auto& pair : hexColors) {
-        if (pair.second == color) {
+    for (size_t i = 0; i < cellOwners.size(); ++i) {
+        if (cellExists[i] && cellOwners[i] == owner) {
             count++;
         }
     }
     return count;
+}
+
+
+const HexOccupant& HexagonalGrid::getOccupant(const Hex& hex) const {
+    static const HexOccupant noOccupant;
+    int index = cellIndex(hex);
+    return index != -1 ? cellOccupants[index] : noOccupant;
+}
+
+void HexagonalGrid::setOccupant(const Hex& hex, const HexOccupant& occupant) {
+    int index = cellIndex(hex);
+    if (index != -1) {
+        writeOccupant(index, occupant);
+    }
+}
+
+void HexagonalGrid::clearOccupant(const Hex& hex, EntityHandle entity) {
+    int index = cellIndex(hex);
+    if (index != -1 && cellOccupants[index].entity == entity) {
+        writeOccupant(index, HexOccupant());
+    }
+}
+
+void HexagonalGrid::writeOccupant(int index, const HexOccupant& occupant) {
+    if (journal) {
+        const HexOccupant& previous = cellOccupants[index];
+        journal->record({JournalField::CellOccupant, NEUTRAL_OWNER, index, packOccupant(previous), previous.entity.toBits()});
+    }
+    assignOccupant(index, occupant);
+    updateFreeCell(index);
+}
+
+void HexagonalGrid::assignOccupant(int index, const HexOccupant& occupant) {
+    OwnerId previousOwner = cellOccupants[index].owner;
+    cellOccupants[index] = occupant;
+
+    // Only the protection by the owners of the old and new occupants can change, on the cell and its neighbors
+    for (OwnerId owner : {previousOwner, occupant.owner}) {
+        if (owner == NEUTRAL_OWNER) {
+            continue;
+        }
+        cellProtection[index * palette.size() + owner] = computeProtection(index, owner);
+        const int* neighbors = cellNeighbors(index);
+        for (int d = 0; d < NB_DIRECTIONS; ++d) {
+            if (neighbors[d] != -1) {
+                cellProtection[neighbors[d] * palette.size() + owner] = computeProtection(neighbors[d], owner);
+            }
+        }
+    }
+}
+
+void HexagonalGrid::updateFreeCell(int index) {
+    bool free = cellOccupants[index].kind == EntityKind::None && (cellOwners[index] == NEUTRAL_OWNER || (cellOwners[index] & DISCONNECTED_FLAG));
+    int position = freeCellPositions[index];
+    if (free && position == -1) {
+        if (journal) {
+            journal->record({JournalField::FreeCellAdded, NEUTRAL_OWNER, index, static_cast<int64_t>(freeCells.size()), 0});
+        }
+        insertFreeCell(index, freeCells.size());
+    } else if (!free && position != -1) {
+        if (journal) {
+            journal->record({JournalField::FreeCellRemoved, NEUTRAL_OWNER, index, position, 0});
+        }
+        removeFreeCell(position);
+    }
+}
+
+void HexagonalGrid::insertFreeCell(int index, size_t position) {
+    if (position < freeCells.size()) {
+        int moved = freeCells[position];
+        freeCellPositions[moved] = freeCells.size();
+        freeCells.push_back(moved);
+        freeCells[position] = index;
+    } else {
+        freeCells.push_back(index);
+    }
+    freeCellPositions[index] = position;
+}
+
+void HexagonalGrid::removeFreeCell(size_t position) {
+    int index = freeCells[position];
+    int last = freeCells.back();
+    freeCells[position] = last;
+    freeCellPositions[last] = position;
+    freeCells.pop_back();
+    freeCellPositions[index] = -1;
+}
+
+int HexagonalGrid::getCellProtection(int index, OwnerId owner) const {
+#ifdef KONKR_DEBUG
+    // Debug builds check the protection map against the occupants
+    assert(cellProtection[index * palette.size() + owner] == computeProtection(index, owner));
+#endif
+    return cellProtection[index * palette.size() + owner];
+}
+
+int HexagonalGrid::computeProtection(int index, OwnerId owner) const {
+    int protection = -1;
+    if (cellOccupants[index].owner == owner && cellOccupants[index].kind != EntityKind::None) {
+        protection = cellOccupants[index].protection;
+    }
+    const int* neighbors = cellNeighbors(index);
+    for (int d = 0; d < NB_DIRECTIONS; ++d) {
+        if (neighbors[d] == -1) {
+            continue;
+        }
+        const HexOccupant& neighbor = cellOccupants[neighbors[d]];
+        if (neighbor.owner == owner && neighbor.kind != EntityKind::None) {
+            protection = std::max(protection, static_cast<int>(neighbor.protection));
+        }
+    }
+    return protection;
+}
+
+void HexagonalGrid::applyJournalEntry(JournalEntry& entry) {
+    switch (entry.field) {
+        case JournalField::CellOwner: {
+            OwnerId current = cellOwners[entry.index];
+            assignCell(entry.index, static_cast<OwnerId>(entry.value));
+            entry.value = current;
+            break;
+        }
+        case JournalField::CellOccupant: {
+            HexOccupant current = cellOccupants[entry.index];
+            assignOccupant(entry.index, unpackOccupant(entry.value, entry.entity));
+            entry.value = packOccupant(current);
+            entry.entity = current.entity.toBits();
+            break;
+        }
+        case JournalField::DirtyCellAdded:
+            dirtyCells.pop_back();
+            entry.field = JournalField::DirtyCellRemoved;
+            break;
+        case JournalField::DirtyCellRemoved:
+            dirtyCells.push_back(entry.index);
+            entry.field = JournalField::DirtyCellAdded;
+            break;
+        case JournalField::FreeCellAdded:
+            removeFreeCell(entry.value);
+            entry.field = JournalField::FreeCellRemoved;
+            break;
+        case JournalField::FreeCellRemoved:
+            insertFreeCell(entry.index, entry.value);
+            entry.field = JournalField::FreeCellAdded;
+            break;
+        default:
+            throw std::invalid_argument("Not a grid journal entry");
+    }
 }
\ No newline at end of file
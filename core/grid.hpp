@@ -1,35 +1,102 @@
 #ifndef HEXAGONAL_GRID_HPP
 #define HEXAGONAL_GRID_HPP
 
-#include <SDL2/SDL2_gfxPrimitives.h>
 #include <stdexcept>
 #include <cmath>
 #include <limits>
+#include <algorithm>
+#include <cassert>
 
 #include "../constants/constants.hpp"
+#include "journal.hpp"
 
-// Redefinition of the operator == for SDL_Color
-inline bool operator==(const SDL_Color& lhs, const SDL_Color& rhs) {
-    return lhs.r == rhs.r &&
-           lhs.g == rhs.g &&
-           lhs.b == rhs.b &&
-           lhs.a == rhs.a;
-}
+// Owner of a hex: 0 is the neutral soil, players are numbered from 1.
+// The high bit flags a hex that is cut from its owner's towns.
+typedef uint16_t OwnerId;
+const OwnerId NEUTRAL_OWNER = 0;
+const OwnerId DISCONNECTED_FLAG = 0x8000;
+const OwnerId OWNER_MASK = 0x7FFF;
+
+// Number of neighbors of a hex
+const int NB_DIRECTIONS = 6;
+
+// Kind of an entity
+enum class EntityKind : uint8_t {
+    None, Bandit, BanditCamp, Treasure, Devil, Forest, Town, Castle, Villager, Pikeman, Knight, Hero
+};
+const int NB_ENTITY_KINDS = 12;
+
+// Set of entity kinds, one bit per kind
+typedef uint16_t EntityKindSet;
+inline constexpr EntityKindSet kindBit(EntityKind kind) { return static_cast<EntityKindSet>(1u << static_cast<unsigned>(kind)); }
+
+// Reference to an entity of the entity store: slot index and generation of the slot,
+// a handle becomes stale when its entity is destroyed even if the slot is reused
+struct EntityHandle {
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != INVALID_INDEX; }
+
+    // Handle packed in one word, as stored in the journal
+    uint64_t toBits() const { return (static_cast<uint64_t>(index) << 32) | generation; }
+    static EntityHandle fromBits(uint64_t bits) {
+        EntityHandle entity;
+        entity.index = static_cast<uint32_t>(bits >> 32);
+        entity.generation = static_cast<uint32_t>(bits);
+        return entity;
+    }
+
+    bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+// Entity standing on a hex, stored with the grid to know what is on a hex without going through the entity lists
+struct HexOccupant {
+    EntityKind kind = EntityKind::None;
+    OwnerId owner = NEUTRAL_OWNER; // Player owning the entity, NEUTRAL_OWNER for bandits, treasures, forests...
+    EntityHandle entity;
+    int8_t protection = 0;         // Protection level the entity gives to its hex and, for a player, to the neighbors
+};
+
+// Part of the grid shown in a window: the camera (top left corner of the window in the pixels of the grid) and the size of the window
+struct GridView {
+    int x, y;
+    int width, height;
+};
 
 // HexagonalGrid class
 class HexagonalGrid {
 private:
     std::vector<Hex> hexes;
-    std::map<Hex, SDL_Color> hexColors; // Map to store the color of each hex
+    std::vector<OwnerId> cellOwners;   // Flat array storing the owner of each cell, indexed by offset coordinates
+    std::vector<bool> cellExists;      // Existence bitmap over the same flat array
+    int gridWidth, gridHeight;         // Size of the flat array in offset coordinates (columns, rows)
+    std::vector<Color> palette;        // Color of each owner, only used for rendering
+    std::vector<int> ownerCases;       // Number of connected hexes of each owner, kept up to date on every write
+    std::vector<int> dirtyCells;       // Cells whose owner changed since the last connectivity update
+    std::vector<HexOccupant> cellOccupants; // Entity standing on each cell
+    std::vector<int> neighborCells;    // NB_DIRECTIONS neighbor cells per cell, in the order of directions, -1 if off the map
+    std::vector<int8_t> cellProtection; // Protection of each cell by each owner (palette.size() values per cell), -1 if none
+    std::vector<int> freeCells;        // Existing cells with no entity and no connected owner, in any order
+    std::vector<int> freeCellPositions; // Position of each cell in freeCells, -1 if the cell is not free
+    uint64_t ownersVersion;            // Incremented each time the owner of a cell changes
+    std::vector<int> changedCells;     // Cell of each change of owner since changedCellsVersion, for the renderers (not journaled)
+    uint64_t changedCellsVersion;      // Version of the owners before the first of changedCells
     double hexSize;
     double offsetX, offsetY; // Offset to center the grid
     const Hex* hoveredHex;
+    Journal* journal;                  // Journal recording the changes of owners, dirty cells and occupants, if any
 
 public:
     HexagonalGrid(double hexSize);
 
     // Generate a grid from an ASCII map
-    void generateFromASCII(const std::vector<std::string>& asciiMap, int windowWidth, int windowHeight);
+    void generateFromASCII(const std::vector<std::string>& asciiMap);
+
+    // Offset the pixel coordinates so that the grid is centered in a window
+    void centerOn(int windowWidth, int windowHeight);
 
     // Convert hex to pixel
     Point hexToPixel(const Hex& hex) const;
@@ -37,14 +104,57 @@ public:
     // Convert pixel to hex
     Hex pixelToHex(int x, int y, int cameraX, int cameraY) const;
 
+    // Index of a hex in the flat storage, -1 if the hex is not in the grid
+    int cellIndex(const Hex& hex) const;
+
+    // Index of a hex in the flat storage whether it is in the grid or not, -1 if it is out of the storage
+    int storageIndex(const Hex& hex) const;
+
     // Check if a hex exists in the grid
-    bool hexExists(const Hex& hex) const; 
+    bool hexExists(const Hex& hex) const { return cellIndex(hex) != -1; }
+
+    // Hex stored at an index of the flat storage
+    Hex cellHex(int index) const;
+
+    // Size of the flat storage (cells that are not in the grid included)
+    int getNbCells() const { return static_cast<int>(cellOwners.size()); }
 
-    // Handle mouse click
-    void handleMouseClick(int mouseX, int mouseY, int cameraX, int cameraY);
+    // Neighbors of an existing cell: NB_DIRECTIONS cell indices in the order of directions, -1 if the neighbor is not in the grid
+    const int* cellNeighbors(int index) const { return &neighborCells[index * NB_DIRECTIONS]; }
 
-    // Draw the grid
-    void draw(SDL_Renderer* renderer, int cameraX, int cameraY) const;
+    // Call fn(index) for every existing cell within a distance of a hex, only the hexes in range are looked at (O(radius²))
+    template <typename Function>
+    void forEachCellInRadius(const Hex& center, int radius, Function fn) const {
+        for (int dq = -radius; dq <= radius; ++dq) {
+            for (int dr = std::max(-radius, -dq - radius); dr <= std::min(radius, radius - dq); ++dr) {
+                int index = cellIndex(Hex(center.getQ() + dq, center.getR() + dr, center.getS() - dq - dr));
+                if (index != -1) {
+                    fn(index);
+                }
+            }
+        }
+    }
+
+    // Call fn(index) for every existing cell that may be seen in a view (the hex, an entity on it or its highlight),
+    // only the rows and columns of the flat storage in the view are looked at
+    template <typename Function>
+    void forEachCellInView(const GridView& view, Function fn) const {
+        int firstRow, lastRow;
+        rowsInView(view, firstRow, lastRow);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            int firstCol, lastCol;
+            columnsInView(view, row, firstCol, lastCol);
+            for (int col = firstCol; col <= lastCol; ++col) {
+                int index = row * gridWidth + col;
+                if (cellExists[index]) {
+                    fn(index);
+                }
+            }
+        }
+    }
+
+    // Check if a hex may be seen in a view
+    bool isInView(const Hex& hex, const GridView& view) const;
 
     // Getter for hexes
     const std::vector<Hex>& getHexes() const { return hexes; }
@@ -52,21 +162,127 @@ public:
     // Getter for hex size
     double getHexSize() const { return hexSize; }
 
-    // Getter for hex colors
-    const std::map<Hex, SDL_Color>& getHexColors() const { return hexColors; }
+    // Number of owners (players) found in the map, owners are numbered from 1 to getNbOwners()
+    OwnerId getNbOwners() const { return static_cast<OwnerId>(palette.size() - 1); }
+
+    // Getter for the owner of a hex, without the disconnected flag (throws std::out_of_range if the hex is not in the grid)
+    OwnerId getOwner(const Hex& hex) const { return cell(hex) & OWNER_MASK; }
+
+    // Check if a hex is cut from its owner's towns
+    bool isDisconnected(const Hex& hex) const { return (cell(hex) & DISCONNECTED_FLAG) != 0; }
+
+    // Owner of an existing cell, without the disconnected flag
+    OwnerId getCellOwner(int index) const { return cellOwners[index] & OWNER_MASK; }
+
+    // Owner of a hex if it is connected to the owner's towns, NEUTRAL_OWNER otherwise
+    OwnerId getConnectedOwner(const Hex& hex) const;
+
+    // Check if a hex is part of the connected territory of an owner
+    bool isOwnedBy(const Hex& hex, OwnerId owner) const;
+
+    // Set the owner of a hex (the hex is connected again)
+    void setOwner(const Hex& hex, OwnerId owner);
+
+    // Flag or unflag a hex as cut from its owner's towns
+    void setDisconnected(const Hex& hex, bool disconnected);
 
-    // Set the color of a hex
-    void setHexColor(const Hex& hex, const SDL_Color& color);
+    // Check if a neighbor of a hex of the grid is part of the connected territory of an owner
+    bool hasNeighborOwnedBy(const Hex& hex, OwnerId owner) const;
 
-    // Check if a neighbor of a hex has a specific color
-    bool hasNeighborWithColor(const Hex& hex, const SDL_Color& color) const;
+    // Get the number of hexes in the connected territory of an owner (O(1), counters are updated on every ownership change)
+    int getNbCasesOwnedBy(OwnerId owner) const;
 
-    //Get the number of cases in a certain color
-    int getNbCasesColor(const SDL_Color& color) const;
+    // Counter changed each time the owner of a cell changes (undo and redo included), for renderers keeping a copy of the territory
+    uint64_t getOwnersVersion() const { return ownersVersion; }
+
+    // Cell of each change of owner (undo and redo included) since getChangedCellsVersion(), in order: the changes after a version v
+    // start at position v - getChangedCellsVersion(). The list is restarted when it gets as long as the storage, the renderers
+    // whose version is older than getChangedCellsVersion() have to repaint everything.
+    const std::vector<int>& getChangedCells() const { return changedCells; }
+    uint64_t getChangedCellsVersion() const { return changedCellsVersion; }
+
+    // Cells whose owner changed (or that were marked dirty) since the last call to clearDirtyCells
+    const std::vector<int>& getDirtyCells() const { return dirtyCells; }
+
+    // Flag a hex so that the territory around it is checked again at the next connectivity update
+    void markDirty(const Hex& hex);
+
+    // Forget the dirty cells once the connectivity has been updated
+    void clearDirtyCells();
+
+    // Getter for the entity standing on a hex (kind None if the hex is empty or not in the grid)
+    const HexOccupant& getOccupant(const Hex& hex) const;
+
+    // Getter for the entity standing on an existing cell
+    const HexOccupant& getCellOccupant(int index) const { return cellOccupants[index]; }
+
+    // Check if an entity stands on a hex
+    bool isOccupied(const Hex& hex) const { return getOccupant(hex).kind != EntityKind::None; }
+
+    // Highest protection level given to an existing cell by the entities of a player standing on it or next to it, -1 if none
+    int getCellProtection(int index, OwnerId owner) const;
+
+    // Cells with no entity and no connected owner, where treasures, devils and bandit camps appear
+    const std::vector<int>& getFreeCells() const { return freeCells; }
+
+    // Register an entity standing on a hex
+    void setOccupant(const Hex& hex, const HexOccupant& occupant);
+
+    // Unregister an entity from a hex, nothing is done if another entity stands on it
+    void clearOccupant(const Hex& hex, EntityHandle entity);
+
+    // Color of an owner in the palette
+    Color getOwnerColor(OwnerId owner) const { return palette.at(owner); }
+
+    // Color to render a hex with, darkened if the hex is disconnected
+    Color getHexColor(const Hex& hex) const;
 
     // set HexSize
     void setHexSize(double size) { hexSize = size; }
 
+    // Record the next changes in a journal (nullptr to stop recording)
+    void setJournal(Journal* journal) { this->journal = journal; }
+
+    // Undo or redo a change of the grid recorded in the journal
+    void applyJournalEntry(JournalEntry& entry);
+
+private:
+    // Raw owner value of a hex, including the disconnected flag
+    OwnerId cell(const Hex& hex) const;
+
+    // Write the raw owner value of a cell and update the owner counters
+    void writeCell(int index, OwnerId value);
+
+    // Update the owner counters and write the raw owner value of a cell, without recording it
+    void assignCell(int index, OwnerId value);
+
+    // Add a cell to the dirty cells
+    void addDirtyCell(int index);
+
+    // Write the entity standing on a cell
+    void writeOccupant(int index, const HexOccupant& occupant);
+
+    // Replace the entity standing on a cell and update the protection of the cell and its neighbors, without recording it
+    void assignOccupant(int index, const HexOccupant& occupant);
+
+    // Protection of a cell by an owner computed from the occupants of the cell and its neighbors
+    int computeProtection(int index, OwnerId owner) const;
+
+    // Add a cell to the free cells or remove it from them after a change of its owner or occupant
+    void updateFreeCell(int index);
+
+    // Append a cell to the free cells (at the end) or put it back at a position, moving the cell there to the end
+    void insertFreeCell(int index, size_t position);
+
+    // Remove the free cell at a position, the last free cell takes its place
+    void removeFreeCell(size_t position);
+
+    // Range of rows, and range of columns of a row, whose hexes may be seen in a view (first > last if none)
+    void rowsInView(const GridView& view, int& firstRow, int& lastRow) const;
+    void columnsInView(const GridView& view, int row, int& firstCol, int& lastCol) const;
+
+    // Count the connected hexes of an owner with a full scan of the grid
+    int countCasesOwnedBy(OwnerId owner) const;
 };
 
 #endif // HEXAGONAL_GRID_HPP
@@ -6,8 +6,6 @@
 #include <string>
 #include <iostream>
 #include <memory>
-#include <SDL2/SDL.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
 
 // Point structure for rendering
 struct Point {
@@ -0,0 +1,39 @@
+#include "journal.hpp"
+
+Journal::Journal() : checkpoints(1, 0), position(0), currentCheckpoint(0) {}
+
+void Journal::record(const JournalEntry& entry) {
+    truncate();
+    entries.push_back(entry);
+    position++;
+}
+
+void Journal::checkpoint() {
+    truncate();
+    checkpoints.push_back(position);
+    currentCheckpoint = checkpoints.size() - 1;
+}
+
+JournalEntry& Journal::stepBack() {
+    position--;
+    return entries[position];
+}
+
+JournalEntry& Journal::stepForward() {
+    position++;
+    return entries[position - 1];
+}
+
+void Journal::clear() {
+    entries.clear();
+    checkpoints.assign(1, 0);
+    position = 0;
+    currentCheckpoint = 0;
+}
+
+void Journal::truncate() {
+    if (position < entries.size()) {
+        entries.resize(position);
+    }
+    checkpoints.resize(currentCheckpoint + 1);
+}
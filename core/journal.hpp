@@ -0,0 +1,78 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Part of the game state changed by a journal entry
+enum class JournalField : uint8_t {
+    // Grid: raw owner of a cell, entity standing on a cell, list of dirty cells, set of free cells
+    CellOwner, CellOccupant, DirtyCellAdded, DirtyCellRemoved, FreeCellAdded, FreeCellRemoved,
+    // Entity store: number of slots, list of free slots, columns of a slot
+    EntitySlots, FreeSlotAdded, FreeSlotRemoved, EntityHex, EntityKind, EntityOwner, EntityValue, EntityMoved, EntityGeneration,
+    // Players
+    PlayerCoins, PlayerTownDestroyed, PlayerAlive, PlayerEntityAdded, PlayerEntityRemoved,
+    // Lists of neutral entities
+    NeutralEntityAdded, NeutralEntityRemoved
+};
+
+// One change of the game state. The entry holds the value replaced by the change:
+// undoing or redoing it swaps that value with the current one, so the same entry serves both ways.
+// Changes to a list (Added/Removed) hold the element and its position, and flip between the two fields.
+struct JournalEntry {
+    JournalField field;
+    uint16_t owner;  // Player of the player fields
+    int index;       // Cell, entity slot or position in a list
+    int64_t value;   // Replaced value, or kind of the entity of a neutral list
+    uint64_t entity; // Entity handle of the occupant and list fields
+};
+
+// Journal of every change of the game state since the start of the game.
+// Checkpoints are the positions undo and redo stop at (the start of each turn).
+class Journal {
+public:
+    Journal();
+
+    // Record a change, the changes undone before it can't be redone anymore
+    void record(const JournalEntry& entry);
+
+    // Mark the current position as a checkpoint, the changes undone before it can't be redone anymore
+    void checkpoint();
+
+    // Number of checkpoints, the start of the game is the first one
+    size_t getNbCheckpoints() const { return checkpoints.size(); }
+
+    // Index of the last checkpoint at or before the current position
+    size_t getCurrentCheckpoint() const { return currentCheckpoint; }
+
+    // Check if changes were recorded since the current checkpoint
+    bool hasChangesSinceCheckpoint() const { return position > checkpoints[currentCheckpoint]; }
+
+    // Entry to swap to go one change back, the position moves before it
+    JournalEntry& stepBack();
+
+    // Entry to swap to go one change forward, the position moves after it
+    JournalEntry& stepForward();
+
+    // Position of a checkpoint in the journal, and current position
+    size_t getCheckpointPosition(size_t checkpoint) const { return checkpoints[checkpoint]; }
+    size_t getPosition() const { return position; }
+
+    // Set the current checkpoint once the position reached it
+    void setCurrentCheckpoint(size_t checkpoint) { currentCheckpoint = checkpoint; }
+
+    // Forget every change, the current state becomes the only checkpoint
+    void clear();
+
+private:
+    // Drop the changes and checkpoints after the current position
+    void truncate();
+
+    std::vector<JournalEntry> entries;
+    std::vector<size_t> checkpoints; // Position of each checkpoint
+    size_t position;                 // Number of entries applied to the game state
+    size_t currentCheckpoint;
+};
+
+#endif // JOURNAL_HPP
@@ -0,0 +1,39 @@
+#include "profiler.hpp"
+#include <algorithm>
+
+Profiler profiler;
+
+void Profiler::setEnabled(bool enabled) {
+    if (enabled && !this->enabled) {
+        counts.fill(0);
+        next.fill(0);
+    }
+    this->enabled = enabled;
+}
+
+void Profiler::record(ProfilePhase phase, double milliseconds) {
+    size_t index = static_cast<size_t>(phase);
+    samples[index][next[index]] = static_cast<float>(milliseconds);
+    next[index] = (next[index] + 1) % NB_SAMPLES;
+    counts[index] = std::min(counts[index] + 1, NB_SAMPLES);
+}
+
+Profiler::Stats Profiler::getStats(ProfilePhase phase) const {
+    size_t index = static_cast<size_t>(phase);
+    size_t count = counts[index];
+    if (count == 0) {
+        return {0, 0.0, 0.0, 0.0};
+    }
+
+    // The samples are in the first positions until the ring is full, their order doesn't matter
+    std::array<float, NB_SAMPLES> sorted = samples[index];
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += sorted[i];
+    }
+    size_t p99Rank = (count * 99 + 99) / 100 - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + p99Rank, sorted.begin() + count);
+    float p99 = sorted[p99Rank];
+    float min = *std::min_element(sorted.begin(), sorted.begin() + count);
+    return {count, min, sum / count, p99};
+}
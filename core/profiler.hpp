@@ -0,0 +1,101 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "trace.hpp"
+
+// Parts of a frame and of a turn timed by the profiler
+enum class ProfilePhase : uint8_t {
+    Frame,      // Whole iteration of the main loop
+    Events,     // Handling of the events
+    Update,     // Updates of the animation
+    Grid,       // Terrain
+    Entities,   // Entities on the grid and the selected one
+    Hud,        // Player info, buttons, texts and the profiler overlay
+    Present,    // SDL_RenderPresent, waits for the screen with vsync
+    EndTurn     // GameEngine::endTurn
+};
+constexpr int NB_PROFILE_PHASES = 8;
+static_assert(static_cast<int>(ProfilePhase::EndTurn) + 1 == NB_PROFILE_PHASES, "NB_PROFILE_PHASES must count the phases");
+
+constexpr std::array<const char*, NB_PROFILE_PHASES> profilePhaseNames = {
+    "frame", "events", "update", "grid", "entities", "hud", "present", "end turn"
+};
+
+// Durations of the last samples of each phase. Nothing is measured while the profiler is disabled,
+// so the timers can stay in release builds: a disabled timer costs a test of a flag.
+class Profiler {
+public:
+    // Statistics of the last samples of a phase, in milliseconds
+    struct Stats {
+        size_t count;
+        double min;
+        double avg;
+        double p99;
+    };
+
+    bool isEnabled() const { return enabled; }
+
+    // Start measuring from scratch, or stop measuring
+    void setEnabled(bool enabled);
+
+    // Add a duration to the samples of a phase, the oldest sample is dropped when there are too many
+    void record(ProfilePhase phase, double milliseconds);
+
+    Stats getStats(ProfilePhase phase) const;
+
+private:
+    static constexpr size_t NB_SAMPLES = 240; // About a second of frames
+
+    bool enabled = false;
+    std::array<std::array<float, NB_SAMPLES>, NB_PROFILE_PHASES> samples = {};
+    std::array<size_t, NB_PROFILE_PHASES> counts = {};  // Number of samples of each phase, up to NB_SAMPLES
+    std::array<size_t, NB_PROFILE_PHASES> next = {};    // Position of the next sample of each phase
+};
+
+// Profiler of the game, shared by the main loop, the rendering and the engine
+extern Profiler profiler;
+
+// Time the rest of a scope as a phase when the profiler is enabled, and record it in the trace when the tracer is
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfilePhase phase) : phase(phase), profiling(profiler.isEnabled()), tracing(tracer.isEnabled()) {
+        if (profiling || tracing) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (profiling || tracing) {
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            if (profiling) {
+                std::chrono::duration<double, std::milli> duration = end - start;
+                profiler.record(phase, duration.count());
+            }
+            if (tracing) {
+                tracer.record(profilePhaseNames[static_cast<size_t>(phase)], start, end);
+            }
+        }
+    }
+
+    // Leave the rest of the scope untimed and record nothing, e.g. for an iteration of the main loop that draws no frame
+    void cancel() {
+        profiling = false;
+        tracing = false;
+    }
+
+    ScopedTimer(const ScopedTimer& other) = delete;
+    ScopedTimer& operator=(const ScopedTimer& other) = delete;
+
+private:
+    ProfilePhase phase;
+    bool profiling;
+    bool tracing;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,40 @@
+#include "random.hpp"
+
+// Spread the bits of a seed over the state (splitmix64), a xoshiro state must not be all zeros
+static uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+Random::Random(uint64_t seed) {
+    for (uint64_t& word : state) {
+        word = splitmix64(seed);
+    }
+}
+
+uint64_t Random::next() {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+}
+
+int Random::uniform(int bound) {
+    // Multiply the high 32 bits by the bound instead of a modulo: faster, and no bias towards small values worth noticing
+    return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+}
+
+Random Random::split() {
+    return Random(next());
+}
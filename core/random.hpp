@@ -0,0 +1,29 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+
+// Fast pseudo-random generator (xoshiro256**): the same seed always gives the same numbers.
+// The game owns its generators and passes them explicitly, nothing uses std::rand.
+class Random {
+public:
+    explicit Random(uint64_t seed = 0);
+
+    // Next 64 random bits
+    uint64_t next();
+
+    // Uniform integer in [0, bound), bound must be positive
+    int uniform(int bound);
+
+    // Independent generator derived from this one, to give each subsystem its own stream
+    Random split();
+
+    bool operator==(const Random& other) const { return state == other.state; }
+    bool operator!=(const Random& other) const { return !(*this == other); }
+
+private:
+    std::array<uint64_t, 4> state;
+};
+
+#endif // RANDOM_HPP
@@ -0,0 +1,72 @@
+#include "trace.hpp"
+#include <cstdio>
+#include <iostream>
+
+Tracer tracer;
+
+Tracer::~Tracer() {
+    finish();
+}
+
+bool Tracer::start(const std::string& path) {
+    file.open(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not create trace file " << path << std::endl;
+        return false;
+    }
+    origin = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Tracer::finish() {
+    if (!file.is_open()) {
+        return;
+    }
+    enabled.store(false, std::memory_order_relaxed);
+
+    // Complete events ("X") with timestamps in microseconds, the oldest event of each thread first
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    char line[256];
+    for (const auto& buffer : buffers) {
+        size_t oldest = (buffer->next + BUFFER_EVENTS - buffer->count) % BUFFER_EVENTS;
+        for (size_t i = 0; i < buffer->count; ++i) {
+            const Event& event = buffer->events[(oldest + i) % BUFFER_EVENTS];
+            std::snprintf(line, sizeof(line), "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                first ? "" : ",", event.name, event.begin / 1000.0, event.duration / 1000.0, buffer->thread);
+            file << line;
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.close();
+    for (const auto& buffer : buffers) {
+        buffer->next = 0;
+        buffer->count = 0;
+    }
+}
+
+void Tracer::record(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = threadBuffer();
+    int64_t beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count();
+    int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    buffer.events[buffer.next] = {name, beginNs, durationNs};
+    buffer.next = (buffer.next + 1) % BUFFER_EVENTS;
+    if (buffer.count < BUFFER_EVENTS) {
+        buffer.count++;
+    }
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(BUFFER_EVENTS);
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer->thread = static_cast<int>(buffers.size()) + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
@@ -0,0 +1,84 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timeline of scoped events written as a Chrome trace, to be opened in chrome://tracing or Perfetto.
+// Each thread records into its own ring buffer without locking, the oldest events of a thread are
+// dropped when its buffer is full. The buffers are written to the file when the trace is finished.
+class Tracer {
+public:
+    ~Tracer();
+
+    // Record events from now on, false if the file can't be created
+    bool start(const std::string& path);
+
+    // Stop recording and write the events of every thread, once the other threads stopped recording
+    void finish();
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Add an event to the buffer of the calling thread, the name must outlive the tracer (a string literal)
+    void record(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end);
+
+private:
+    struct Event {
+        const char* name;
+        int64_t begin;      // Nanoseconds since the start of the trace
+        int64_t duration;   // Nanoseconds
+    };
+
+    struct ThreadBuffer {
+        int thread;                 // Thread id shown in the trace, in order of the first event of each thread
+        std::vector<Event> events;  // Ring of BUFFER_EVENTS events
+        size_t next = 0;            // Position of the next event
+        size_t count = 0;           // Number of events, up to BUFFER_EVENTS
+    };
+
+    // Buffer of the calling thread, created and registered at its first event
+    ThreadBuffer& threadBuffer();
+
+    static constexpr size_t BUFFER_EVENTS = 1 << 16;
+
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point origin;
+    std::ofstream file;
+    std::mutex buffersMutex;                            // Taken when a thread registers its buffer and when writing
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers; // Kept alive after their thread exits
+};
+
+// Tracer of the game, enabled by the --trace command-line option
+extern Tracer tracer;
+
+// Record the rest of a scope as an event of the trace, when the tracer is enabled and the scope is worth tracing
+class ScopedTrace {
+public:
+    explicit ScopedTrace(const char* name, bool traced = true) : name(name), running(traced && tracer.isEnabled()) {
+        if (running) {
+            begin = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTrace() {
+        if (running) {
+            tracer.record(name, begin, std::chrono::steady_clock::now());
+        }
+    }
+
+    ScopedTrace(const ScopedTrace& other) = delete;
+    ScopedTrace& operator=(const ScopedTrace& other) = delete;
+
+private:
+    const char* name;
+    bool running;
+    std::chrono::steady_clock::time_point begin;
+};
+
+#endif // TRACE_HPP
@@ -0,0 +1,441 @@
+#include "gameengine.hpp"
+#include "../core/profiler.hpp"
+
+// Where a bought entity waits until it is dropped on the grid
+static const Hex offGridHex(-1000, 0, 1000);
+
+GameEngine::GameEngine(double hexSize, const std::vector<std::string>& asciiMap, const std::vector<std::string>& entityMap, uint64_t seed)
+    : grid(hexSize),
+    playerTurn(0),
+    nbplayers(0),
+    turn(0),
+    seed(seed),
+    legalMovesValid(false)
+{
+    Random random(seed);
+    Random mapRandom = random.split();
+    banditRandom = random.split();
+    eventRandom = random.split();
+
+    grid.generateFromASCII(asciiMap);
+
+    // Create one player per owner found in the grid
+    for (OwnerId owner = 1; owner <= grid.getNbOwners(); ++owner) {
+        nbplayers++;
+        gameEntities.players.emplace_back(std::make_shared<Player>(owner));
+    }
+
+    // A map without players has nothing to play, getNbPlayers() tells the caller
+    if(nbplayers == 0) {
+        return;
+    }
+
+    // Generate entities based on the entityMap
+    entityManager.generateEntities(entityMap, asciiMap, grid, gameEntities, mapRandom);
+
+    // Changes are recorded from now on, the initial state is the first checkpoint
+    history.start(grid, gameEntities, getTurnState());
+}
+
+ActionResult GameEngine::endTurn() {
+    ScopedTimer timer(ProfilePhase::EndTurn);
+    if (nbplayers <= 1) {
+        return ActionResult::GameOver;
+    }
+    stateChanged();
+
+    // if entities on hex not existing on the grid refund the cost of the entity
+    if(isEntitySelected()) {
+        refundIfNotPlaced(selectedEntity);
+    }
+    selectedEntity = EntityHandle();
+
+    playerManager.updateTerritoryConnectivity(grid, gameEntities);
+
+    // Remove dead players
+    std::vector<std::shared_ptr<Player>> toRemove;
+    for (auto& player : gameEntities.players) {
+        if (player->isTownDestroyed() && player->isAlive()) {
+            toRemove.push_back(player);
+        }
+    }
+    for (auto& player : toRemove) {
+        playerManager.removePlayer(player, nbplayers, grid, gameEntities);
+    }
+#ifdef KONKR_DEBUG
+    assert(entityManager.occupancyMatchesEntities(grid, gameEntities));
+#endif
+    // Change player
+    playerTurn = (playerTurn + 1) % gameEntities.players.size();
+    while(!gameEntities.players[playerTurn]->isAlive()) {
+        playerTurn = (playerTurn + 1) % gameEntities.players.size();
+    }
+
+    auto& currentPlayer = gameEntities.players[playerTurn];
+
+    // BANDIT, TREASURE AND DEVIL ACTIONS HERE
+    if (playerTurn == 0) {
+        ScopedTrace trace("bandits, treasures and devils");
+        turn++;
+        if(turn > 0) {
+            entityManager.manageBandits(grid, gameEntities, banditRandom);
+        }
+        if(gameEntities.treasures.empty()) {
+            int treasureValue = eventRandom.uniform(10) + 1;
+            if(eventRandom.uniform(4) == 0) {
+                Hex treasureHex = entityManager.randomfreeHex(grid, eventRandom);
+                if(treasureHex.getQ() != -1000 && treasureHex.getR() != 0 && treasureHex.getS() != 1000) {
+                    entityManager.addNeutralEntity(grid, gameEntities, EntityKind::Treasure, treasureHex, treasureValue);
+                }
+            }
+        }
+
+        if (gameEntities.devils.empty()) {
+            if(eventRandom.uniform(1000) == 0) {
+                Hex devilHex = entityManager.randomfreeHex(grid, eventRandom);
+                if(devilHex.getQ() != -1000 && devilHex.getR() != 0 && devilHex.getS() != 1000) {
+                    entityManager.addNeutralEntity(grid, gameEntities, EntityKind::Devil, devilHex);
+                    // kill all the entities around the devil but the towns and the units stronger than the devil
+                    const EntityKindSet victimKinds = kindBit(EntityKind::Bandit) | kindBit(EntityKind::BanditCamp) | kindBit(EntityKind::Treasure)
+                        | kindBit(EntityKind::Castle) | kindBit(EntityKind::Villager) | kindBit(EntityKind::Pikeman) | kindBit(EntityKind::Knight) | kindBit(EntityKind::Hero);
+                    std::vector<EntityHandle> entitiesToRemove;
+                    forEachInRadius(devilHex, 1, victimKinds, [&](const HexOccupant& occupant) {
+                        if (occupant.owner == NEUTRAL_OWNER || entityTraits(occupant.kind).protection <= 2) {
+                            entitiesToRemove.push_back(occupant.entity);
+                        }
+                    });
+                    entityManager.removeEntities(grid, gameEntities, entitiesToRemove);
+                }
+            }
+        } else {
+            // remove all the devils
+            while(!gameEntities.devils.empty()) {
+                entityManager.removeEntity(grid, gameEntities, gameEntities.devils.back());
+            }
+
+        }
+    }
+
+    // END OF BANDIT, TREASURE AND DEVIL ACTIONS
+
+    if(turn > 0) {
+        ScopedTrace trace("income and upkeep");
+        // Add land income based on the number of hexes owned by the current player
+        currentPlayer->addCoins(grid.getNbCasesOwnedBy(currentPlayer->getOwner()));
+
+        // Prepare entities for the next turn and handle upkeep costs
+        EntityStore& store = gameEntities.store;
+        std::vector<EntityHandle> entitiesToRemove;
+        for(EntityHandle entity : currentPlayer->getEntities()) {
+            bool isBuilding = store.isBuilding(entity);
+
+            // Reset movement for non-building entities if there are multiple players
+            if(!isBuilding && gameEntities.players.size() > 1) {
+                store.setMoved(entity, false);
+            }
+
+            int upkeepCost = store.getUpkeep(entity);
+
+            // Deduct upkeep cost or replace the entity with a bandit/bandit camp if insufficient funds
+            if(currentPlayer->getCoins() >= upkeepCost) {
+                currentPlayer->removeCoins(upkeepCost);
+            } else {
+                entitiesToRemove.push_back(entity);
+            }
+        }
+
+        // Replace entities that couldn't pay their upkeep
+        for(EntityHandle entity : entitiesToRemove) {
+            Hex entityHex = store.getHex(entity);
+            bool isBuilding = store.isBuilding(entity);
+            entityManager.removeEntity(grid, gameEntities, entity);
+            if(isBuilding) {
+                // Replace building with a bandit camp, the territory around a lost town has to be checked again
+                entityManager.addNeutralEntity(grid, gameEntities, EntityKind::BanditCamp, entityHex);
+                grid.markDirty(entityHex);
+            } else {
+                // Replace unit with a bandit
+                entityManager.addNeutralEntity(grid, gameEntities, EntityKind::Bandit, entityHex);
+            }
+        }
+    }
+
+    return ActionResult::Ok;
+}
+
+ActionResult GameEngine::buy(EntityKind kind, const Hex& hex) {
+    ScopedTrace trace("buy");
+    ActionResult result = checkPurchase(kind);
+    if (result == ActionResult::Ok) {
+        result = checkMove(kind, offGridHex, hex);
+    }
+    if (result != ActionResult::Ok) {
+        return result;
+    }
+
+    stateChanged();
+    auto& buyer = *gameEntities.players[playerTurn];
+    EntityHandle entity = entityManager.addPlayerEntity(grid, gameEntities, buyer, kind, offGridHex);
+    buyer.removeCoins(entityTraits(kind).cost);
+    return move(entity, hex);
+}
+
+ActionResult GameEngine::buyEntity(EntityKind kind, const Hex& hex) {
+    ScopedTrace trace("buy");
+    ActionResult result = checkPurchase(kind);
+    if (result != ActionResult::Ok) {
+        return result;
+    }
+    if (isEntitySelected()) {
+        return ActionResult::SelectionActive;
+    }
+
+    stateChanged();
+    // A bought entity can't share a hex with another one, it then waits out of the grid to be placed
+    auto& buyer = *gameEntities.players[playerTurn];
+    Hex buyHex = grid.isOccupied(hex) ? offGridHex : hex;
+    entityManager.addPlayerEntity(grid, gameEntities, buyer, kind, buyHex);
+    buyer.removeCoins(entityTraits(kind).cost);
+    return ActionResult::Ok;
+}
+
+void GameEngine::selectEntity(const Hex& hex) {
+    ScopedTrace trace("select");
+    if (isEntitySelected() || playerTurn >= gameEntities.players.size()) {
+        return;
+    }
+    EntityStore& store = gameEntities.store;
+    auto& currentPlayer = gameEntities.players[playerTurn];
+    const auto& playerEntities = currentPlayer->getEntities();
+
+    for (size_t i = 0; i < playerEntities.size(); ++i) {
+        if (!store.hasMoved(playerEntities[i]) && store.getHex(playerEntities[i]) == hex) {
+            if(store.isBuilding(playerEntities[i]) && grid.hexExists(hex)) {
+                continue;
+            }
+            selectedEntity = playerEntities[i];
+            break;
+        }
+    }
+}
+
+void GameEngine::moveSelectedEntity(const Hex& target) {
+    if (!isEntitySelected()) {
+        selectedEntity = EntityHandle();
+        return;
+    }
+    EntityHandle entity = selectedEntity;
+    selectedEntity = EntityHandle();
+    move(entity, target);
+}
+
+ActionResult GameEngine::move(EntityHandle entity, const Hex& target) {
+    ScopedTrace trace("move");
+    ActionResult result = checkMover(entity);
+    if (result != ActionResult::Ok) {
+        return result;
+    }
+
+    stateChanged();
+    EntityStore& store = gameEntities.store;
+    auto& currentPlayer = gameEntities.players[playerTurn];
+    EntityKind kind = store.getKind(entity);
+    result = checkMove(kind, store.getHex(entity), target);
+    if (result != ActionResult::Ok) {
+        // A bought entity dropped on a wrong hex is given back
+        refundIfNotPlaced(entity);
+        return result;
+    }
+
+    if (playerManager.hasSamePlayerEntities(target, *currentPlayer, grid) != EntityKind::None) {
+        // Merge with the entity of the same kind on the target hex
+        entityManager.removeEntity(grid, gameEntities, entity);
+        entityManager.upgradeEntity(grid, target, gameEntities);
+        return ActionResult::Ok;
+    }
+
+    bool targetOwned = grid.isOwnedBy(target, currentPlayer->getOwner());
+    // Copied as the move replaces the occupant of the target hex
+    const HexOccupant occupant = grid.getOccupant(target);
+
+    if(kind == EntityKind::Castle && !entityManager.entityOnHex(target, grid) && targetOwned) {
+        store.setMoved(entity, true);
+    }
+    entityManager.moveEntity(grid, store, entity, target);
+
+    // remove potential bandit, bandit camp, treasure or devil on the hex we are moving to
+    switch (occupant.kind) {
+        case EntityKind::Bandit:
+        case EntityKind::BanditCamp:
+            store.setMoved(entity, true);
+            break;
+        case EntityKind::Treasure:
+            // give the coins to the player
+            currentPlayer->addCoins(store.getValue(occupant.entity));
+            break;
+        case EntityKind::Devil:
+            // the player beat the devil
+            currentPlayer->addCoins(store.getUpkeep(occupant.entity));
+            break;
+        default:
+            break;
+    }
+    if (occupant.owner == NEUTRAL_OWNER && occupant.kind != EntityKind::None) {
+        entityManager.removeEntity(grid, gameEntities, occupant.entity);
+    }
+
+    // We flag the entity as moved if it left the territory of its player
+    if(!targetOwned) {
+        store.setMoved(entity, true);
+        // remove potential entity of another player on the hex we are moving to
+        if (occupant.owner != NEUTRAL_OWNER && occupant.owner != currentPlayer->getOwner()) {
+            auto& player = gameEntities.playerOf(occupant.owner);
+            if (occupant.kind == EntityKind::Town) {
+                player->setTownDestroyed(true);
+                int coinsOfDeadPlayer = player->getCoins();
+                currentPlayer->addCoins(coinsOfDeadPlayer);
+            }
+            entityManager.removeEntity(grid, gameEntities, occupant.entity);
+        }
+    }
+    return ActionResult::Ok;
+}
+
+const std::vector<Hex>& GameEngine::legalMoves(EntityHandle entity) const {
+    if (legalMovesValid && legalMovesEntity == entity) {
+        return legalMovesHexes;
+    }
+
+    legalMovesHexes.clear();
+    if (checkMover(entity) == ActionResult::Ok) {
+        EntityKind kind = gameEntities.store.getKind(entity);
+        const Hex& from = gameEntities.store.getHex(entity);
+        for (const Hex& hex : grid.getHexes()) {
+            if (checkMove(kind, from, hex) == ActionResult::Ok) {
+                legalMovesHexes.push_back(hex);
+            }
+        }
+    }
+    legalMovesEntity = entity;
+    legalMovesValid = true;
+    return legalMovesHexes;
+}
+
+bool GameEngine::isEntitySelected() const {
+    const EntityStore& store = gameEntities.store;
+    return selectedEntity.isValid() && store.isAlive(selectedEntity) && playerTurn < gameEntities.players.size()
+        && store.getOwner(selectedEntity) == gameEntities.players[playerTurn]->getOwner();
+}
+
+EntityHandle GameEngine::getSelectedEntity() const {
+    return isEntitySelected() ? selectedEntity : EntityHandle();
+}
+
+ActionResult GameEngine::checkMover(EntityHandle entity) const {
+    if (nbplayers <= 1) {
+        return ActionResult::GameOver;
+    }
+    const EntityStore& store = gameEntities.store;
+    if (!store.isAlive(entity)) {
+        return ActionResult::InvalidEntity;
+    }
+    if (store.getOwner(entity) != gameEntities.players[playerTurn]->getOwner()) {
+        return ActionResult::NotOwned;
+    }
+    if (store.hasMoved(entity) || (store.isBuilding(entity) && grid.hexExists(store.getHex(entity)))) {
+        return ActionResult::CannotMove;
+    }
+    return ActionResult::Ok;
+}
+
+ActionResult GameEngine::checkPurchase(EntityKind kind) const {
+    if (nbplayers <= 1) {
+        return ActionResult::GameOver;
+    }
+    int cost = entityTraits(kind).cost;
+    if (cost == 0) {
+        return ActionResult::NotBuyable;
+    }
+    if (cost > gameEntities.players[playerTurn]->getCoins()) {
+        return ActionResult::NotEnoughCoins;
+    }
+    return ActionResult::Ok;
+}
+
+ActionResult GameEngine::checkMove(EntityKind kind, const Hex& from, const Hex& target) const {
+    if (!grid.hexExists(target)) {
+        return ActionResult::InvalidHex;
+    }
+    const Player& currentPlayer = *gameEntities.players[playerTurn];
+    OwnerId owner = currentPlayer.getOwner();
+    EntityKind kindOnTarget = playerManager.hasSamePlayerEntities(target, currentPlayer, grid);
+    bool protectedTarget = entityManager.isSurroundedByOtherPlayerEntities(target, currentPlayer, entityTraits(kind).protection, grid);
+
+    if (!protectedTarget && kindOnTarget == EntityKind::None) {
+        // Entities go anywhere in their territory, or conquer a hex next to it
+        if (grid.isOwnedBy(target, owner) || grid.hasNeighborOwnedBy(target, owner)) {
+            return ActionResult::Ok;
+        }
+        return ActionResult::Unreachable;
+    }
+
+    // Two entities of the same kind merge into a stronger one, heroes and castles don't
+    if (!(from == target) && kind == kindOnTarget && kind != EntityKind::Hero && kind != EntityKind::Castle) {
+        return ActionResult::Ok;
+    }
+    return kindOnTarget != EntityKind::None ? ActionResult::Occupied : ActionResult::Protected;
+}
+
+void GameEngine::saveCheckpoint() {
+    ScopedTrace trace("checkpoint");
+    history.checkpoint(getTurnState());
+}
+
+void GameEngine::undoTurn() {
+    ScopedTrace trace("undo");
+    stateChanged();
+    TurnState state = getTurnState();
+    if (history.undo(grid, gameEntities, state)) {
+        setTurnState(state);
+    }
+}
+
+void GameEngine::redoTurn() {
+    ScopedTrace trace("redo");
+    stateChanged();
+    TurnState state = getTurnState();
+    if (history.redo(grid, gameEntities, state)) {
+        setTurnState(state);
+    }
+}
+
+void GameEngine::restart() {
+    ScopedTrace trace("restart");
+    stateChanged();
+    TurnState state = getTurnState();
+    history.restart(grid, gameEntities, state);
+    setTurnState(state);
+}
+
+TurnState GameEngine::getTurnState() const {
+    return {playerTurn, turn, nbplayers, selectedEntity, banditRandom, eventRandom};
+}
+
+void GameEngine::setTurnState(const TurnState& state) {
+    playerTurn = state.playerTurn;
+    turn = state.turn;
+    nbplayers = state.nbplayers;
+    selectedEntity = state.selectedEntity;
+    banditRandom = state.banditRandom;
+    eventRandom = state.eventRandom;
+}
+
+void GameEngine::refundIfNotPlaced(EntityHandle entity) {
+    EntityStore& store = gameEntities.store;
+    if (grid.hexExists(store.getHex(entity))) {
+        return;
+    }
+    // refund the cost of the entity
+    gameEntities.playerOf(store.getOwner(entity))->addCoins(store.getTraits(entity).cost);
+    entityManager.removeEntity(grid, gameEntities, entity);
+}
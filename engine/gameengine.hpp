@@ -0,0 +1,124 @@
+#ifndef GAMEENGINE_HPP
+#define GAMEENGINE_HPP
+
+#include "../players/playermanager.hpp"
+#include "gamehistory.hpp"
+
+// Outcome of an action of the current player, nothing changes unless it is Ok
+enum class ActionResult {
+    Ok,
+    GameOver,       // Less than two players are alive
+    InvalidEntity,  // The entity was removed from the game
+    NotOwned,       // The entity belongs to another player
+    CannotMove,     // The entity already moved this turn, or is a building placed on the grid
+    NotBuyable,     // The kind of entity can't be bought
+    NotEnoughCoins, // The player can't pay for the entity
+    InvalidHex,     // The hex is not on the grid
+    Protected,      // The hex is protected by stronger entities of another player
+    Occupied,       // The hex holds an entity of the player it can't merge with
+    Unreachable,    // The hex is neither in the territory of the player nor next to it
+    SelectionActive // An entity is being dragged, it has to be dropped first
+};
+
+// Rules of the game, without rendering nor input handling: a frontend turns the input of the players
+// into calls to the actions below and draws the grid and the entities it exposes.
+class GameEngine {
+public:
+    // The same seed and the same actions always play the same game. Nothing is printed: a map without players
+    // generates no entities, check getNbPlayers()
+    GameEngine(double hexSize, const std::vector<std::string>& asciiMap, const std::vector<std::string>& entityMap, uint64_t seed);
+
+    // The grid and the entities record their changes in the history of the game, an engine is not copied
+    GameEngine(const GameEngine& other) = delete;
+    GameEngine& operator=(const GameEngine& other) = delete;
+
+    // Actions of the current player, for bots, replays and tools: the same checks as the input of the frontend,
+    // without going through the selection. Call saveCheckpoint() after endTurn() to stop undo at the new turn.
+
+    // Buy an entity and place it on a hex (conquest, capture or merge), as if dragged from a buy button
+    ActionResult buy(EntityKind kind, const Hex& hex);
+
+    // Move an entity of the current player to a hex (conquest, capture or merge)
+    ActionResult move(EntityHandle entity, const Hex& target);
+
+    // End the turn of the current player: territories, dead players, bandits, treasures, devils, then income and upkeep of the next player
+    ActionResult endTurn();
+
+    // Buy an entity for the current player to be dragged from a button, it waits out of the grid if the hex is occupied
+    ActionResult buyEntity(EntityKind kind, const Hex& hex);
+
+    // Select the entity of the current player standing on a hex, if it can still move
+    void selectEntity(const Hex& hex);
+
+    // Move the selected entity to a hex (conquest, capture or upgrade), the selection is dropped
+    void moveSelectedEntity(const Hex& target);
+
+    // Hexes an entity of the current player can move to (move() returns Ok), empty if it can't move.
+    // The set is computed once and kept until another entity is asked for or the game state changes.
+    const std::vector<Hex>& legalMoves(EntityHandle entity) const;
+
+    // Call fn(occupant) for every entity of a set of kinds (kindBit(...) | ...) standing within a distance of a hex, for area effects
+    template <typename Function>
+    void forEachInRadius(const Hex& hex, int radius, EntityKindSet kinds, Function fn) const {
+        entityManager.forEachInRadius(grid, hex, radius, kinds, fn);
+    }
+
+    // Remember the current state as the start of a turn, where undo and redo stop
+    void saveCheckpoint();
+
+    // Go back to the start of the turn (or of the previous turn), forward to the turn undone, or to the start of the game
+    void undoTurn();
+    void redoTurn();
+    void restart();
+
+    // Getters
+    const HexagonalGrid& getGrid() const { return grid; }
+    HexagonalGrid& getGrid() { return grid; } // Zoom and centering of the grid
+    const GameEntities& getGameEntities() const { return gameEntities; }
+    GameEntities& getGameEntities() { return gameEntities; } // Jump animation of the entities
+    size_t getPlayerTurn() const { return playerTurn; }
+    // The selected entity is still alive and belongs to the current player
+    bool isEntitySelected() const;
+    EntityHandle getSelectedEntity() const; // Invalid handle if no entity is selected
+    int getNbPlayers() const { return nbplayers; }
+    int getTurn() const { return turn; }
+    uint64_t getSeed() const { return seed; }
+
+private:
+    // State of the game kept out of the grid and the entities
+    TurnState getTurnState() const;
+    void setTurnState(const TurnState& state);
+
+    // Checks shared by the actions: can the current player pay for a kind, can an entity of a kind go from a hex to another
+    ActionResult checkPurchase(EntityKind kind) const;
+    ActionResult checkMover(EntityHandle entity) const;
+    ActionResult checkMove(EntityKind kind, const Hex& from, const Hex& target) const;
+
+    // Every action goes through here before changing the game, the legal moves are computed again when asked
+    void stateChanged() { legalMovesValid = false; }
+
+    // Remove a bought entity that was not placed on the grid and give its cost back
+    void refundIfNotPlaced(EntityHandle entity);
+
+    HexagonalGrid grid;
+    EntityManager entityManager;
+    PlayerManager playerManager;
+    GameEntities gameEntities;
+    GameHistory history;
+    size_t playerTurn;
+    EntityHandle selectedEntity; // Checked against the store when used, the actions may remove or merge it
+    int nbplayers;
+    int turn;
+
+    // One random stream per subsystem, derived from the seed
+    uint64_t seed;
+    Random banditRandom; // Moves and spawns of the bandits
+    Random eventRandom;  // Treasures and devils appearing
+
+    // Cache of legalMoves()
+    mutable bool legalMovesValid;
+    mutable EntityHandle legalMovesEntity;
+    mutable std::vector<Hex> legalMovesHexes;
+};
+
+#endif // GAMEENGINE_HPP
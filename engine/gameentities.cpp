@@ -0,0 +1,64 @@
+#include "gameentities.hpp"
+
+void GameEntities::addNeutralEntity(EntityKind kind, EntityHandle entity) {
+    std::vector<EntityHandle>& entities = neutralEntities(kind);
+    if (journal) {
+        journal->record({JournalField::NeutralEntityAdded, NEUTRAL_OWNER, static_cast<int>(entities.size()), static_cast<int64_t>(kind), entity.toBits()});
+    }
+    entities.push_back(entity);
+}
+
+void GameEntities::removeNeutralEntity(EntityKind kind, EntityHandle entity) {
+    std::vector<EntityHandle>& entities = neutralEntities(kind);
+    auto it = std::find(entities.begin(), entities.end(), entity);
+    if (it == entities.end()) {
+        return;
+    }
+    if (journal) {
+        journal->record({JournalField::NeutralEntityRemoved, NEUTRAL_OWNER, static_cast<int>(it - entities.begin()), static_cast<int64_t>(kind), entity.toBits()});
+    }
+    entities.erase(it);
+}
+
+void GameEntities::removeNeutralEntities(EntityKind kind, const std::vector<EntityHandle>& removed) {
+    removeEntitiesFromList(neutralEntities(kind), removed, [&](int position, EntityHandle entity) {
+        if (journal) {
+            journal->record({JournalField::NeutralEntityRemoved, NEUTRAL_OWNER, position, static_cast<int64_t>(kind), entity.toBits()});
+        }
+    });
+}
+
+void GameEntities::setJournal(Journal* journal) {
+    this->journal = journal;
+    store.setJournal(journal);
+    for (auto& player : players) {
+        player->setJournal(journal);
+    }
+}
+
+void GameEntities::applyJournalEntry(JournalEntry& entry) {
+    switch (entry.field) {
+        case JournalField::NeutralEntityAdded: {
+            std::vector<EntityHandle>& entities = neutralEntities(static_cast<EntityKind>(entry.value));
+            entities.erase(entities.begin() + entry.index);
+            entry.field = JournalField::NeutralEntityRemoved;
+            break;
+        }
+        case JournalField::NeutralEntityRemoved: {
+            std::vector<EntityHandle>& entities = neutralEntities(static_cast<EntityKind>(entry.value));
+            entities.insert(entities.begin() + entry.index, EntityHandle::fromBits(entry.entity));
+            entry.field = JournalField::NeutralEntityAdded;
+            break;
+        }
+        case JournalField::PlayerCoins:
+        case JournalField::PlayerTownDestroyed:
+        case JournalField::PlayerAlive:
+        case JournalField::PlayerEntityAdded:
+        case JournalField::PlayerEntityRemoved:
+            playerOf(entry.owner)->applyJournalEntry(entry);
+            break;
+        default:
+            store.applyJournalEntry(entry);
+            break;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef GAMEENTITIES_HPP
+#define GAMEENTITIES_HPP
+
+#include "../players/player.hpp"
+
+struct GameEntities {
+    EntityStore store; // Every entity of the game, the lists below hold handles into it
+    std::vector<std::shared_ptr<Player>> players;
+    std::vector<EntityHandle> bandits;
+    std::vector<EntityHandle> banditCamps;
+    std::vector<EntityHandle> treasures;
+    std::vector<EntityHandle> devils;
+    std::vector<EntityHandle> forests;
+    Journal* journal = nullptr; // Journal recording the changes of the store, the players and the lists, if any
+
+    // Player of an owner id, players are stored in owner order (owner 1 is players[0])
+    const std::shared_ptr<Player>& playerOf(OwnerId owner) const { return players[owner - 1]; }
+
+    // List of the neutral entities of a kind (bandits, bandit camps, treasures, devils or forests)
+    std::vector<EntityHandle>& neutralEntities(EntityKind kind) {
+        switch (kind) {
+            case EntityKind::Bandit: return bandits;
+            case EntityKind::BanditCamp: return banditCamps;
+            case EntityKind::Treasure: return treasures;
+            case EntityKind::Devil: return devils;
+            case EntityKind::Forest: return forests;
+            default: throw std::invalid_argument("Not a neutral entity kind");
+        }
+    }
+
+    // Add a neutral entity at the end of the list of its kind
+    void addNeutralEntity(EntityKind kind, EntityHandle entity);
+
+    // Remove a neutral entity from the list of its kind
+    void removeNeutralEntity(EntityKind kind, EntityHandle entity);
+
+    // Remove neutral entities of a kind from its list, the list is compacted once
+    void removeNeutralEntities(EntityKind kind, const std::vector<EntityHandle>& removed);
+
+    // Record the next changes of the store, the players and the lists in a journal (nullptr to stop recording)
+    void setJournal(Journal* journal);
+
+    // Undo or redo a change of the store, a player or a list recorded in the journal
+    void applyJournalEntry(JournalEntry& entry);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "gamehistory.hpp"
+#include "../core/trace.hpp"
+
+void GameHistory::start(HexagonalGrid& grid, GameEntities& gameEntities, const TurnState& state) {
+    journal.clear();
+    turnStates.assign(1, state);
+    grid.setJournal(&journal);
+    gameEntities.setJournal(&journal);
+}
+
+void GameHistory::checkpoint(const TurnState& state) {
+    // The states of the checkpoints dropped by the journal are dropped as well
+    journal.checkpoint();
+    turnStates.resize(journal.getNbCheckpoints() - 1);
+    turnStates.push_back(state);
+}
+
+bool GameHistory::hasChangesSinceCheckpoint(const TurnState& state) const {
+    return journal.hasChangesSinceCheckpoint() || state != turnStates[journal.getCurrentCheckpoint()];
+}
+
+bool GameHistory::undo(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state) {
+    // The changes since the start of the turn become a checkpoint, so that they can be redone
+    if (hasChangesSinceCheckpoint(state)) {
+        checkpoint(state);
+    }
+    size_t current = journal.getCurrentCheckpoint();
+    if (current == 0) {
+        return false;
+    }
+    moveTo(current - 1, grid, gameEntities);
+    state = turnStates[current - 1];
+    return true;
+}
+
+bool GameHistory::redo(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state) {
+    size_t next = journal.getCurrentCheckpoint() + 1;
+    if (journal.hasChangesSinceCheckpoint() || next >= journal.getNbCheckpoints()) {
+        return false;
+    }
+    moveTo(next, grid, gameEntities);
+    state = turnStates[next];
+    return true;
+}
+
+void GameHistory::restart(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state) {
+    moveTo(0, grid, gameEntities);
+    state = turnStates[0];
+    journal.clear();
+    turnStates.resize(1);
+}
+
+void GameHistory::moveTo(size_t checkpoint, HexagonalGrid& grid, GameEntities& gameEntities) {
+    ScopedTrace trace("apply journal");
+    size_t position = journal.getCheckpointPosition(checkpoint);
+    while (journal.getPosition() > position) {
+        apply(journal.stepBack(), grid, gameEntities);
+    }
+    while (journal.getPosition() < position) {
+        apply(journal.stepForward(), grid, gameEntities);
+    }
+    journal.setCurrentCheckpoint(checkpoint);
+}
+
+void GameHistory::apply(JournalEntry& entry, HexagonalGrid& grid, GameEntities& gameEntities) {
+    switch (entry.field) {
+        case JournalField::CellOwner:
+        case JournalField::CellOccupant:
+        case JournalField::DirtyCellAdded:
+        case JournalField::DirtyCellRemoved:
+        case JournalField::FreeCellAdded:
+        case JournalField::FreeCellRemoved:
+            grid.applyJournalEntry(entry);
+            break;
+        default:
+            gameEntities.applyJournalEntry(entry);
+            break;
+    }
+}
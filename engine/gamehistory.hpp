@@ -0,0 +1,58 @@
+#ifndef GAMEHISTORY_HPP
+#define GAMEHISTORY_HPP
+
+#include "../core/random.hpp"
+#include "gameentities.hpp"
+
+// State of the game kept out of the grid and the entities, saved at each checkpoint
+struct TurnState {
+    size_t playerTurn;
+    int turn;
+    int nbplayers;
+    EntityHandle selectedEntity; // Entity of the current player being dragged, invalid if none
+    Random banditRandom; // Generators are restored with the turn, playing it again draws the same numbers
+    Random eventRandom;
+
+    bool operator==(const TurnState& other) const {
+        return playerTurn == other.playerTurn && turn == other.turn && nbplayers == other.nbplayers
+            && selectedEntity == other.selectedEntity
+            && banditRandom == other.banditRandom && eventRandom == other.eventRandom;
+    }
+    bool operator!=(const TurnState& other) const { return !(*this == other); }
+};
+
+// Undo and redo of turns. Every change of the grid and the entities is recorded in a journal,
+// going back or forward replays the recorded changes instead of copying the game.
+class GameHistory {
+public:
+    // Start recording the changes of a game, its current state is the first checkpoint
+    void start(HexagonalGrid& grid, GameEntities& gameEntities, const TurnState& state);
+
+    // Remember the state reached at the end of a turn
+    void checkpoint(const TurnState& state);
+
+    // Check if the game changed since the last checkpoint (an entity selected is a change)
+    bool hasChangesSinceCheckpoint(const TurnState& state) const;
+
+    // Go back to the start of the current turn, or to the start of the previous turn if nothing was done since.
+    // Returns false if there is nothing to undo.
+    bool undo(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state);
+
+    // Go forward to the next checkpoint left by undo, returns false if there is nothing to redo
+    bool redo(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state);
+
+    // Go back to the start of the game and forget everything that happened since
+    void restart(HexagonalGrid& grid, GameEntities& gameEntities, TurnState& state);
+
+private:
+    // Replay the journal up to a checkpoint, backwards or forwards
+    void moveTo(size_t checkpoint, HexagonalGrid& grid, GameEntities& gameEntities);
+
+    // Undo or redo one change
+    void apply(JournalEntry& entry, HexagonalGrid& grid, GameEntities& gameEntities);
+
+    Journal journal;
+    std::vector<TurnState> turnStates; // State of the game at each checkpoint
+};
+
+#endif // GAMEHISTORY_HPP
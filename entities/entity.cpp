@@ -1,91 +1,26 @@
 #include "entity.hpp"
 
-// --- Entity Class Implementation ---
-
-Entity::Entity(Hex hex, int protection_level, std::string name, int upkeep) :
-    hex(hex),
-    protection_level(protection_level),
-    moved(false),
-    name(name),
-    upkeep(upkeep),
-    yOffset(0.0f),
-    jumpSpeed(0.5f),
-    jumping(false) {}
-
-
-Entity::~Entity() {}
-
-bool Entity::move(HexagonalGrid& grid, Hex target, const SDL_Color& ownerColor) {
-    if (grid.hexExists(target)) {
-        auto it = grid.getHexColors().find(target);
-        if (it != grid.getHexColors().end()) {
-            const SDL_Color& targetColor = it->second;
-
-            // Check if the target color matches the owner's color
-            if (targetColor == ownerColor) {
-                // Move the entity to the target hex
-                hex = target;
-                return true;
-            } else {
-                // Check if the target is a valid position on the grid
-                if (grid.hasNeighborWithColor(target, ownerColor)) {
-                    hex = target;
-
-                    // Change the color of the hex to the owner's color
-                    grid.setHexColor(target, ownerColor);
-                    return true;
-                }
-            }
+const std::array<EntityTraits, NB_ENTITY_KINDS> entityTraitsTable = {{
+    // name          icon              protection upkeep cost building
+    {"",            Icon::None,       0,         0,     0,   false}, // None
+    {"bandit",      Icon::Bandit,     0,         0,     0,   false}, // Bandit
+    {"bandit_camp", Icon::BanditCamp, 1,         0,     0,   true},  // BanditCamp
+    {"treasure",    Icon::Treasury,   0,         0,     0,   true},  // Treasure
+    {"devil",       Icon::Devil,      2,         100,   0,   false}, // Devil
+    {"forest",      Icon::Forest,     10,        0,     0,   true},  // Forest
+    {"town",        Icon::Town,       1,         0,     0,   true},  // Town
+    {"castle",      Icon::Castle,     2,         2,     20,  true},  // Castle
+    {"villager",    Icon::Villager,   1,         2,     10,  false}, // Villager
+    {"pikeman",     Icon::Pikeman,    2,         6,     20,  false}, // Pikeman
+    {"knight",      Icon::Knight,     3,         18,    40,  false}, // Knight
+    {"hero",        Icon::Hero,       4,         54,    80,  false}  // Hero
+}};
+
+EntityKind entityKindFromName(const std::string& name) {
+    for (size_t i = 1; i < entityTraitsTable.size(); ++i) {
+        if (name == entityTraitsTable[i].name) {
+            return static_cast<EntityKind>(i);
         }
     }
-    return false;
-}
-
-
-
-// --- Bandit Class Implementation ---
-
-Bandit::Bandit(Hex hex) 
-    : Entity(hex, 0, "bandit", 0) {}
-
-Bandit::~Bandit() {}
-
-bool Bandit::moveBandit(HexagonalGrid& grid, Hex target) {
-    if(grid.hexExists(target)) {
-        hex = target;
-        return true;
-    }
-    return false;
+    return EntityKind::None;
 }
-
-// --- Villager Class Implementation ---
-
-Villager::Villager(Hex hex) 
-    : Entity(hex, 1, "villager", 2) {}
-
-Villager::~Villager() {}
-
-// --- Pikeman Class Implementation ---
-
-Pikeman::Pikeman(Hex hex) 
-    : Entity(hex, 2, "pikeman", 6) {}
-
-Pikeman::~Pikeman() {}
-
-// --- Knight Class Implementation ---
-Knight::Knight(Hex hex) 
-    : Entity(hex, 3, "knight", 18) {}
-
-Knight::~Knight() {}
-
-// --- Hero Class Implementation ---
-Hero::Hero(Hex hex) 
-    : Entity(hex, 4, "hero", 54) {}
-
-Hero::~Hero() {}
-
-// --- Devil Class Implementation ---
-
-Devil::Devil(Hex hex) 
-    : Entity(hex, 2, "devil", 100) {}
-Devil::~Devil() {}
\ No newline at end of file
@@ -1,35 +1,23 @@
 #include "entitymanager.hpp"
 
-void EntityManager::addEntityToPlayer(char entityType, const Hex& hex, std::shared_ptr<Player>& player) {
-    std::shared_ptr<Entity> entity;
+void EntityManager::addEntityToPlayer(HexagonalGrid& grid, GameEntities& gameEntities, char entityType, const Hex& hex, Player& player) {
+    EntityKind kind;
     switch (entityType) {
-        case 'T':
-            entity = std::make_shared<Town>(hex);
-            entity->setMoved(true);
-            break;
-        case 'V':
-            entity = std::make_shared<Villager>(hex);
-            break;
-        case 'C':
-            entity = std::make_shared<Castle>(hex);
-            entity->setMoved(true);
-            break;
-        case 'P':
-            entity = std::make_shared<Pikeman>(hex);
-            break;
-        case 'K':
-            entity = std::make_shared<Knight>(hex);
-            break;
-        case 'H':
-            entity = std::make_shared<Hero>(hex);
-            break;
+        case 'T': kind = EntityKind::Town; break;
+        case 'V': kind = EntityKind::Villager; break;
+        case 'C': kind = EntityKind::Castle; break;
+        case 'P': kind = EntityKind::Pikeman; break;
+        case 'K': kind = EntityKind::Knight; break;
+        case 'H': kind = EntityKind::Hero; break;
         default:
             return;
     }
-    player->addEntity(entity);
+    EntityHandle entity = addPlayerEntity(grid, gameEntities, player, kind, hex);
+    // Buildings never move
+    gameEntities.store.setMoved(entity, gameEntities.store.isBuilding(entity));
 }
 
-void EntityManager::generateEntities(const std::vector<std::string>& entityMap, const std::vector<std::string>& asciiMap, HexagonalGrid& grid, GameEntities& gameEntities) {
+void EntityManager::generateEntities(const std::vector<std::string>& entityMap, const std::vector<std::string>& asciiMap, HexagonalGrid& grid, GameEntities& gameEntities, Random& random) {
     // Check if the entity map has the same number of characters on each row as the ASCII map
     if (entityMap.size() != asciiMap.size()) {
         std::cerr << "Error: Entity map and ASCII map have different number of rows." << std::endl;
@@ -64,36 +52,26 @@ void EntityManager::generateEntities(const std::vector<std::string>& entityMap,
 
             switch (c) {
                 case 'B':
-                    addBandit(hex, gameEntities.bandits);
+                    addNeutralEntity(grid, gameEntities, EntityKind::Bandit, hex);
                     break;
                 case 'c':
-                    addBanditCamp(hex, gameEntities.banditCamps);
+                    addNeutralEntity(grid, gameEntities, EntityKind::BanditCamp, hex);
                     break;
                 case 't': {
-                    int treasureValue = std::rand() % 10 + 1;
-                    addTreasure(hex, treasureValue, gameEntities.treasures);
+                    int treasureValue = random.uniform(10) + 1;
+                    addNeutralEntity(grid, gameEntities, EntityKind::Treasure, hex, treasureValue);
                     break;
                 }
                 case 'f': {
-                    addForest(hex, gameEntities.forests);
+                    addNeutralEntity(grid, gameEntities, EntityKind::Forest, hex);
                     break;
                 }
 
                 default: {
-                    SDL_Color hexColor = grid.getHexColors().at(hex);
-
-                    // Find the player whose color matches with hex.
-                    std::shared_ptr<Player> playerForEntity = nullptr;
-                    for (auto& player : gameEntities.players) {
-                        if (player->getColor() == hexColor) {
-                            playerForEntity = player;
-                            break;
-                        }
-                    }
-                    
-                    // Add the entity to the player.
-                    if (playerForEntity) {
-                        addEntityToPlayer(c, hex, playerForEntity);
+                    // Add the entity to the player owning the hex.
+                    OwnerId owner = grid.getOwner(hex);
+                    if (owner != NEUTRAL_OWNER) {
+                        addEntityToPlayer(grid, gameEntities, c, hex, *gameEntities.playerOf(owner));
                     }
                     break;
                 }
@@ -102,103 +80,70 @@ void EntityManager::generateEntities(const std::vector<std::string>& entityMap,
     }
 }
 
-void EntityManager::upgradeEntity(const Hex& hex, std::vector<std::shared_ptr<Player>>& players) {
-    for (auto& player : players) {
-        for (auto& entity : player->getEntities()) {
-            if (entity->getHex() == hex) {
-                bool hasmoved = entity->hasMoved();
-                if (entity->getName() == "villager") {
-                    player->removeEntity(entity);
-                    player->addEntity(std::make_shared<Pikeman>(hex));
-                    player->getEntities().back()->setMoved(hasmoved);
-                    return;
-                } else if (entity->getName() == "pikeman") {
-                    player->removeEntity(entity);
-                    player->addEntity(std::make_shared<Knight>(hex));
-                    player->getEntities().back()->setMoved(hasmoved);
-                    return;
-                } else if (entity->getName() == "knight") {
-                    player->removeEntity(entity);
-                    player->addEntity(std::make_shared<Hero>(hex));
-                    player->getEntities().back()->setMoved(hasmoved);
-                    return;
-                }
-            }
-        }
+void EntityManager::upgradeEntity(HexagonalGrid& grid, const Hex& hex, GameEntities& gameEntities) {
+    const HexOccupant occupant = grid.getOccupant(hex);
+    if (occupant.owner == NEUTRAL_OWNER) {
+        return;
     }
+    EntityKind upgradedKind;
+    switch (occupant.kind) {
+        case EntityKind::Villager: upgradedKind = EntityKind::Pikeman; break;
+        case EntityKind::Pikeman: upgradedKind = EntityKind::Knight; break;
+        case EntityKind::Knight: upgradedKind = EntityKind::Hero; break;
+        default:
+            return;
+    }
+    bool hasmoved = gameEntities.store.hasMoved(occupant.entity);
+    removeEntity(grid, gameEntities, occupant.entity);
+    EntityHandle upgraded = addPlayerEntity(grid, gameEntities, *gameEntities.playerOf(occupant.owner), upgradedKind, hex);
+    gameEntities.store.setMoved(upgraded, hasmoved);
 }
 
-bool EntityManager::entityOnHex(const Hex& hex, const GameEntities& gameEntities) const {
-    for(const auto& bandit : gameEntities.bandits) {
-        if (bandit->getHex() == hex) {
-            return true;
-        }
-    }
-    for(const auto& banditcamp : gameEntities.banditCamps) {
-        if (banditcamp->getHex() == hex) {
+bool EntityManager::entityOnHex(const Hex& hex, const HexagonalGrid& grid) const {
+    return grid.isOccupied(hex);
+}
+
+bool EntityManager::moveEntity(HexagonalGrid& grid, EntityStore& store, EntityHandle entity, const Hex& target) const {
+    if (grid.hexExists(target)) {
+        OwnerId owner = store.getOwner(entity);
+        // Check if the target is already part of the owner's territory
+        if (grid.isOwnedBy(target, owner)) {
+            // Move the entity to the target hex
+            placeEntity(grid, store, entity, target);
             return true;
-        }
-    }
-    for (const auto& player : gameEntities.players) {
-        for (const auto& entity : player->getEntities()) {
-            if (entity->getHex() == hex) {
+        } else {
+            // Check if the target is a valid position on the grid
+            if (grid.hasNeighborOwnedBy(target, owner)) {
+                placeEntity(grid, store, entity, target);
+
+                // Give the hex to the owner
+                grid.setOwner(target, owner);
                 return true;
             }
         }
     }
-    for (const auto& treasure : gameEntities.treasures) {
-        if (treasure->getHex() == hex) {
-            return true;
-        }
-    }
-    for (const auto& devil : gameEntities.devils) {
-        if (devil->getHex() == hex) {
-            return true;
-        }
-    }
-    for (const auto& forest : gameEntities.forests) {
-        if (forest->getHex() == hex) {
-            return true;
-        }
-    }
     return false;
 }
 
-void EntityManager::moveBanditToNewPosition(HexagonalGrid& grid, std::shared_ptr<Bandit>& bandit, const GameEntities& gameEntities) {
+void EntityManager::placeEntity(HexagonalGrid& grid, EntityStore& store, EntityHandle entity, const Hex& target) const {
+    // Change the hex of the entity and keep the occupancy index of the grid up to date
+    grid.clearOccupant(store.getHex(entity), entity);
+    store.setHex(entity, target);
+    grid.setOccupant(target, {store.getKind(entity), store.getOwner(entity), entity, static_cast<int8_t>(store.getProtectionLevel(entity))});
+}
+
+void EntityManager::moveBanditToNewPosition(HexagonalGrid& grid, EntityStore& store, EntityHandle bandit, Random& random) {
     bool moved = false;
     int maxAttempts = 10;
     int attempts = 0;
 
+    const int* neighbors = grid.cellNeighbors(grid.cellIndex(store.getHex(bandit)));
     while (!moved && attempts < maxAttempts) {
-        Hex direction = directions[std::rand() % directions.size()];
-        Hex newHex = bandit->getHex().add(direction);
-
-        bool treasureOnHex = false;
-        for (const auto& treasure : gameEntities.treasures) {
-            if (treasure->getHex() == newHex) {
-                treasureOnHex = true;
-                break;
-            }
-        }
-
-        bool devilOnHex = false;
-        for (const auto& devil : gameEntities.devils) {
-            if (devil->getHex() == newHex) {
-                devilOnHex = true;
-                break;
-            }
-        }
-
-        bool forestOnHex = false;
-        for (const auto& forest : gameEntities.forests) {
-            if (forest->getHex() == newHex) {
-                forestOnHex = true;
-                break;
-            }
-        }
+        int newCell = neighbors[random.uniform(NB_DIRECTIONS)];
 
-        if (grid.hexExists(newHex) && !entityOnHex(newHex, gameEntities) && !treasureOnHex && !devilOnHex && !forestOnHex) {
-            bandit->moveBandit(grid, newHex);
+        // Bandits only move to free hexes (no treasure, devil, forest or any other entity)
+        if (newCell != -1 && grid.getCellOccupant(newCell).kind == EntityKind::None) {
+            placeEntity(grid, store, bandit, grid.cellHex(newCell));
             moved = true;
         } else {
             attempts++;
@@ -206,40 +151,30 @@ void EntityManager::moveBanditToNewPosition(HexagonalGrid& grid, std::shared_ptr
     }
 }
 
-void EntityManager::stealCoinFromPlayer(HexagonalGrid& grid, const std::shared_ptr<Bandit>& bandit, std::vector<std::shared_ptr<BanditCamp>>& banditCamps, const std::vector<std::shared_ptr<Player>>& players) {
-    Hex banditHex = bandit->getHex();
-    SDL_Color hexColor = grid.getHexColors().at(banditHex);
-    for (const auto& player : players) {
-        if (hexColor == player->getColor()) {
-            player->removeCoins(1);
-
-            std::shared_ptr<BanditCamp> nearestBanditCamp = nullptr;
-            int minDistance = std::numeric_limits<int>::max();
-            for (const auto& banditCamp : banditCamps) {
-                int distance = banditHex.distance(banditCamp->getHex());
-                if (distance < minDistance) {
-                    minDistance = distance;
-                    nearestBanditCamp = banditCamp;
-                }
-            }
-            if (nearestBanditCamp) {
-                nearestBanditCamp->addCoins(1);
-            }
+void EntityManager::stealCoinFromPlayer(const HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle bandit) {
+    int banditCell = grid.cellIndex(gameEntities.store.getHex(bandit));
+    OwnerId owner = grid.getConnectedOwner(gameEntities.store.getHex(bandit));
+    if (owner != NEUTRAL_OWNER) {
+        gameEntities.playerOf(owner)->removeCoins(1);
+
+        // The coin goes to the nearest camp
+        if (nearestCamp[banditCell] != -1) {
+            gameEntities.store.addValue(gameEntities.banditCamps[nearestCamp[banditCell]], 1);
         }
     }
 }
 
-void EntityManager::spawnBanditFromCamp(HexagonalGrid& grid, std::shared_ptr<BanditCamp>& banditCamp, std::vector<std::shared_ptr<Bandit>>& bandits, const GameEntities& gameEntities) {
+void EntityManager::spawnBanditFromCamp(HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle banditCamp, Random& random) {
     int maxAttempts = 100;
     int attempts = 0;
     bool placed = false;
+    const int* neighbors = grid.cellNeighbors(grid.cellIndex(gameEntities.store.getHex(banditCamp)));
     while (!placed && attempts < maxAttempts) {
-        Hex direction = directions[std::rand() % directions.size()];
-        Hex newHex = banditCamp->getHex().add(direction);
+        int newCell = neighbors[random.uniform(NB_DIRECTIONS)];
 
-        if (grid.hexExists(newHex) && !entityOnHex(newHex, gameEntities)) {
-            addBandit(newHex, bandits);
-            banditCamp->removeCoins(5);
+        if (newCell != -1 && grid.getCellOccupant(newCell).kind == EntityKind::None) {
+            addNeutralEntity(grid, gameEntities, EntityKind::Bandit, grid.cellHex(newCell));
+            gameEntities.store.addValue(banditCamp, -5);
             placed = true;
         } else {
             attempts++;
@@ -247,160 +182,199 @@ void EntityManager::spawnBanditFromCamp(HexagonalGrid& grid, std::shared_ptr<Ban
     }
 }
 
-bool EntityManager::banditCampNearBandit(const Hex& hex, const std::vector<std::shared_ptr<BanditCamp>>& banditCamps) const {
-    for (const auto& banditCamp : banditCamps) {
-        if (banditCamp->getHex().distance(hex) <= 5) {
-            return true;
-        }
-    }
-    return false;
+bool EntityManager::banditCampNearBandit(const Hex& hex, const HexagonalGrid& grid) const {
+    int cell = grid.cellIndex(hex);
+    return cell != -1 && campDistance[cell] != -1 && campDistance[cell] <= 5;
 }
 
-void EntityManager::spawnCampIfNeeded(HexagonalGrid& grid, const std::vector<std::shared_ptr<Bandit>>& bandits, GameEntities& gameEntities) {
-    for(const auto& bandit : bandits) {
-        if(!banditCampNearBandit(bandit->getHex(), gameEntities.banditCamps)) {
-            Hex campHex = randomfreeHex(grid, gameEntities);
-            if(grid.hexExists(campHex) && !entityOnHex(campHex, gameEntities)) {
-                addBanditCamp(campHex, gameEntities.banditCamps);
+void EntityManager::spawnCampIfNeeded(HexagonalGrid& grid, GameEntities& gameEntities, Random& random) {
+    for(EntityHandle bandit : gameEntities.bandits) {
+        if(!banditCampNearBandit(gameEntities.store.getHex(bandit), grid)) {
+            Hex campHex = randomfreeHex(grid, random);
+            if(grid.hexExists(campHex) && !grid.isOccupied(campHex)) {
+                addNeutralEntity(grid, gameEntities, EntityKind::BanditCamp, campHex);
                 return; // Max one camp per turn
             }
         }
     }
 }
 
-void EntityManager::manageBandits(HexagonalGrid& grid, GameEntities& gameEntities) {
-    for (auto& bandit : gameEntities.bandits) {
-        moveBanditToNewPosition(grid, bandit, gameEntities);
-        stealCoinFromPlayer(grid, bandit, gameEntities.banditCamps, gameEntities.players);
+// Breadth-first search from every camp at once over the whole flat storage, water and holes included:
+// the storage is a rectangle of offset coordinates, so the steps through it are the hex distance.
+// A cell at the same distance of several camps gets the first one of the list, like a scan of the camps.
+void EntityManager::computeCampDistances(const HexagonalGrid& grid, const GameEntities& gameEntities) {
+    campDistance.assign(grid.getNbCells(), -1);
+    nearestCamp.assign(grid.getNbCells(), -1);
+    campQueue.clear();
+    for (size_t i = 0; i < gameEntities.banditCamps.size(); ++i) {
+        int cell = grid.cellIndex(gameEntities.store.getHex(gameEntities.banditCamps[i]));
+        if (cell != -1 && campDistance[cell] == -1) {
+            campDistance[cell] = 0;
+            nearestCamp[cell] = i;
+            campQueue.push_back(cell);
+        }
     }
-    spawnCampIfNeeded(grid, gameEntities.bandits, gameEntities);
-
-    int banditCost = 5;
-    for (auto& banditCamp : gameEntities.banditCamps) {
-        if (banditCamp->getCoins() >= banditCost) {
-            spawnBanditFromCamp(grid, banditCamp, gameEntities.bandits, gameEntities);
+    for (size_t i = 0; i < campQueue.size(); ++i) {
+        int cell = campQueue[i];
+        Hex hex = grid.cellHex(cell);
+        for (int d = 0; d < NB_DIRECTIONS; ++d) {
+            int neighbor = grid.storageIndex(hex.add(directions[d]));
+            if (neighbor == -1) {
+                continue;
+            }
+            if (campDistance[neighbor] == -1) {
+                campDistance[neighbor] = campDistance[cell] + 1;
+                nearestCamp[neighbor] = nearestCamp[cell];
+                campQueue.push_back(neighbor);
+            } else if (campDistance[neighbor] == campDistance[cell] + 1 && nearestCamp[cell] < nearestCamp[neighbor]) {
+                nearestCamp[neighbor] = nearestCamp[cell];
+            }
         }
     }
 }
 
-void EntityManager::addBandit(const Hex& hex, std::vector<std::shared_ptr<Bandit>>& bandits) {
-    bandits.push_back(std::make_shared<Bandit>(hex));
-}
+// The camps don't change while the bandits move and steal, one distance field serves the whole phase
+void EntityManager::manageBandits(HexagonalGrid& grid, GameEntities& gameEntities, Random& random) {
+    computeCampDistances(grid, gameEntities);
+    for (EntityHandle bandit : gameEntities.bandits) {
+        moveBanditToNewPosition(grid, gameEntities.store, bandit, random);
+        stealCoinFromPlayer(grid, gameEntities, bandit);
+    }
+    spawnCampIfNeeded(grid, gameEntities, random);
 
-void EntityManager::addBanditCamp(const Hex& hex, std::vector<std::shared_ptr<BanditCamp>>& banditCamps) {
-    banditCamps.push_back(std::make_shared<BanditCamp>(hex));
+    int banditCost = 5;
+    for (EntityHandle banditCamp : gameEntities.banditCamps) {
+        if (gameEntities.store.getValue(banditCamp) >= banditCost) {
+            spawnBanditFromCamp(grid, gameEntities, banditCamp, random);
+        }
+    }
 }
 
-void EntityManager::addTreasure(const Hex& hex, int value, std::vector<std::shared_ptr<Treasure>>& treasures) {
-    treasures.push_back(std::make_shared<Treasure>(hex, value));
+EntityHandle EntityManager::addNeutralEntity(HexagonalGrid& grid, GameEntities& gameEntities, EntityKind kind, const Hex& hex, int value) {
+    EntityHandle entity = gameEntities.store.create(kind, hex, NEUTRAL_OWNER, value);
+    gameEntities.addNeutralEntity(kind, entity);
+    grid.setOccupant(hex, {kind, NEUTRAL_OWNER, entity, static_cast<int8_t>(entityTraits(kind).protection)});
+    return entity;
 }
 
-void EntityManager::addDevil(const Hex& hex, std::vector<std::shared_ptr<Devil>>& devils) {
-    devils.push_back(std::make_shared<Devil>(hex));
+EntityHandle EntityManager::addPlayerEntity(HexagonalGrid& grid, GameEntities& gameEntities, Player& player, EntityKind kind, const Hex& hex) {
+    // Units being bought are held on a virtual hex out of the grid, they are not registered on the grid
+    EntityHandle entity = gameEntities.store.create(kind, hex, player.getOwner());
+    player.addEntity(entity);
+    grid.setOccupant(hex, {kind, player.getOwner(), entity, static_cast<int8_t>(entityTraits(kind).protection)});
+    return entity;
 }
 
-void EntityManager::addForest(const Hex& hex, std::vector<std::shared_ptr<Forest>>& forests) {
-    forests.push_back(std::make_shared<Forest>(hex));
+void EntityManager::removeEntity(HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle entity) {
+    EntityStore& store = gameEntities.store;
+    grid.clearOccupant(store.getHex(entity), entity);
+    OwnerId owner = store.getOwner(entity);
+    if (owner != NEUTRAL_OWNER) {
+        gameEntities.playerOf(owner)->removeEntity(entity);
+    } else {
+        gameEntities.removeNeutralEntity(store.getKind(entity), entity);
+    }
+    store.destroy(entity);
 }
 
-bool EntityManager::isSurroundedByOtherPlayerEntities(const Hex& hex, const Player& currentPlayer, const int& currentLevel, const HexagonalGrid& grid, const GameEntities& gameEntities) const {
-    for (auto& player : gameEntities.players) {
-        if (player->getColor() == currentPlayer.getColor()) {
-            continue;
-        }
-
-        for (const auto& direction : directions) {
-            Hex neighbor = hex.add(direction);
-            if (grid.hexExists(neighbor)) {
-                for (const auto& entity : player->getEntities()) {
-                    if (entity->getHex() == neighbor &&
-                        entity->getProtectionLevel() >= currentLevel &&
-                        grid.getHexColors().at(hex) == player->getColor()) {
-                        return true;
-                    }
-                }
-            }
-        }
-
-        for (const auto& entity : player->getEntities()) {
-            if (entity->getHex() == hex &&
-                grid.getHexColors().at(hex) == player->getColor()) {
-                if (entity->getProtectionLevel() >= currentLevel) {
-                    return true;
-                } else {
-                    return false;
-                }
-            }
+void EntityManager::removeEntities(HexagonalGrid& grid, GameEntities& gameEntities, const std::vector<EntityHandle>& entities) {
+    // Group the entities by list so that each list is compacted once
+    EntityStore& store = gameEntities.store;
+    std::vector<std::vector<EntityHandle>> playerEntities(gameEntities.players.size());
+    std::array<std::vector<EntityHandle>, NB_ENTITY_KINDS> neutralEntities;
+    for (EntityHandle entity : entities) {
+        grid.clearOccupant(store.getHex(entity), entity);
+        OwnerId owner = store.getOwner(entity);
+        if (owner != NEUTRAL_OWNER) {
+            playerEntities[owner - 1].push_back(entity);
+        } else {
+            neutralEntities[static_cast<size_t>(store.getKind(entity))].push_back(entity);
         }
     }
-    for (const auto& banditcamp : gameEntities.banditCamps) {
-        if (banditcamp->getHex() == hex && banditcamp->getProtectionLevel() >= currentLevel) {
-            return true;
+    for (OwnerId owner = 1; owner <= playerEntities.size(); ++owner) {
+        if (!playerEntities[owner - 1].empty()) {
+            gameEntities.playerOf(owner)->removeEntities(playerEntities[owner - 1]);
         }
     }
-    for (const auto& devil : gameEntities.devils) {
-        if (devil->getHex() == hex && devil->getProtectionLevel() >= currentLevel) {
-            return true;
+    for (int kind = 0; kind < NB_ENTITY_KINDS; ++kind) {
+        if (!neutralEntities[kind].empty()) {
+            gameEntities.removeNeutralEntities(static_cast<EntityKind>(kind), neutralEntities[kind]);
         }
     }
-    for (const auto& forest : gameEntities.forests) {
-        if (forest->getHex() == hex && forest->getProtectionLevel() >= currentLevel) {
-            return true;
-        }
+    for (EntityHandle entity : entities) {
+        store.destroy(entity);
     }
-    return false;
 }
 
-bool EntityManager::HexNotOnTerritoryAndAccessible(const std::shared_ptr<Entity>& entity, const Hex& targetHex, const HexagonalGrid& grid, size_t playerTurn, const GameEntities& gameEntities) const {
-    // Check if the hex exists in the grid
-    if (!grid.hexExists(targetHex)) {
-        return false;
+bool EntityManager::occupancyMatchesEntities(const HexagonalGrid& grid, const GameEntities& gameEntities) const {
+    // Every entity on the grid is registered on its hex, and the number of registered hexes is the number of entities
+    const EntityStore& store = gameEntities.store;
+    size_t nbEntities = 0;
+    bool matches = true;
+    auto check = [&](const std::vector<EntityHandle>& entities) {
+        for (EntityHandle entity : entities) {
+            if (!store.isAlive(entity)) {
+                matches = false;
+                continue;
+            }
+            if (!grid.hexExists(store.getHex(entity))) {
+                continue;
+            }
+            nbEntities++;
+            const HexOccupant& occupant = grid.getOccupant(store.getHex(entity));
+            matches = matches && occupant.entity == entity && occupant.kind == store.getKind(entity) && occupant.owner == store.getOwner(entity);
+        }
+    };
+    check(gameEntities.forests);
+    check(gameEntities.treasures);
+    check(gameEntities.devils);
+    check(gameEntities.banditCamps);
+    check(gameEntities.bandits);
+    for (const auto& player : gameEntities.players) {
+        check(player->getEntities());
     }
 
-    // Get the current player
-    auto& currentPlayer = gameEntities.players[playerTurn];
-
-    // Check if hex is adjacent to the owner's territory
-    SDL_Color ownerColor = currentPlayer->getColor();
-    if (!grid.hasNeighborWithColor(targetHex, ownerColor)) {
-        return false;
+    size_t nbOccupied = 0;
+    for (const Hex& hex : grid.getHexes()) {
+        if (grid.isOccupied(hex)) {
+            nbOccupied++;
+        }
     }
+    return matches && nbOccupied == nbEntities;
+}
 
-    // Check if the hex is not on the player's territory
-    if (grid.getHexColors().at(targetHex) == currentPlayer->getColor()) {
-        return false;
+bool EntityManager::isSurroundedByOtherPlayerEntities(const Hex& hex, const Player& currentPlayer, const int& currentLevel, const HexagonalGrid& grid) const {
+    // Only the player owning the hex can protect it, with the entities on the hex and its neighbors
+    int index = grid.cellIndex(hex);
+    OwnerId owner = grid.getConnectedOwner(hex);
+    if (owner != NEUTRAL_OWNER && owner != currentPlayer.getOwner() && grid.getCellProtection(index, owner) >= currentLevel) {
+        return true;
     }
 
-    // Check if the hex is surrounded by stronger entities from other players
-    if (isSurroundedByOtherPlayerEntities(targetHex, *currentPlayer, entity->getProtectionLevel(), grid, gameEntities)) {
-        return false;
+    // Bandit camps, devils and forests protect their own hex
+    const HexOccupant& occupant = grid.getCellOccupant(index);
+    if (occupant.kind == EntityKind::BanditCamp || occupant.kind == EntityKind::Devil || occupant.kind == EntityKind::Forest) {
+        return occupant.protection >= currentLevel;
     }
-
-    return true;
+    return false;
 }
 
-Hex EntityManager::randomfreeHex(const HexagonalGrid& grid, const GameEntities& gameEntities) const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(0, grid.getHexes().size() - 1);
-    int randomIndex = distrib(gen);
-    Hex randomHex = grid.getHexes()[randomIndex];
-    SDL_Color hexColor = grid.getHexColors().at(randomHex);
-    std::vector<SDL_Color> playerColors;
-    for(auto& player : gameEntities.players) {
-        playerColors.push_back(player->getColor());
-    }
-    // check that the Hex is not occupated and not owned by a player
-    int maxAttempts = 100;
-    int attempts = 0;
-    while(entityOnHex(randomHex, gameEntities) || (std::find(playerColors.begin(), playerColors.end(), hexColor) != playerColors.end())) {
-        randomIndex = distrib(gen);
-        randomHex = grid.getHexes()[randomIndex];
-        hexColor = grid.getHexColors().at(randomHex);
-        attempts++;
-        if(attempts >= maxAttempts) {
-            return Hex(-1000, 0, 1000);
+Hex EntityManager::randomfreeHex(const HexagonalGrid& grid, Random& random) const {
+    // Uniform pick among the hexes that are not occupied and not owned by a player
+    const std::vector<int>& freeCells = grid.getFreeCells();
+#ifdef KONKR_DEBUG
+    // Debug builds check the free cells against a full scan
+    size_t nbFree = 0;
+    for (const Hex& hex : grid.getHexes()) {
+        if (!grid.isOccupied(hex) && grid.getConnectedOwner(hex) == NEUTRAL_OWNER) {
+            nbFree++;
         }
     }
-    return randomHex;
-}
\ No newline at end of file
+    assert(nbFree == freeCells.size());
+#endif
+    if (freeCells.empty()) {
+        return Hex(-1000, 0, 1000);
+    }
+    int cell = freeCells[random.uniform(freeCells.size())];
+    return grid.cellHex(cell);
+}
@@ -1,31 +1,49 @@
 #ifndef ENTITYMANAGER_HPP
 #define ENTITYMANAGER_HPP
 
-#include <random>
-
-#include "../game/gameentities.hpp"
+#include "../core/random.hpp"
+#include "../engine/gameentities.hpp"
 
 class EntityManager {
 public:
-    void generateEntities(const std::vector<std::string>& entityMap, const std::vector<std::string>& asciiMap, HexagonalGrid& grid, GameEntities& gameEntities);
-    void upgradeEntity(const Hex& hex, std::vector<std::shared_ptr<Player>>& players);
-    bool entityOnHex(const Hex& hex, const GameEntities& gameEntities) const;
-    void manageBandits(HexagonalGrid& grid, GameEntities& gameEntities);
-    void addBandit(const Hex& hex, std::vector<std::shared_ptr<Bandit>>& bandits);
-    void addBanditCamp(const Hex& hex, std::vector<std::shared_ptr<BanditCamp>>& banditCamps);
-    void addTreasure(const Hex& hex, int value, std::vector<std::shared_ptr<Treasure>>& treasures);
-    void addDevil(const Hex& hex, std::vector<std::shared_ptr<Devil>>& devils);
-    void addForest(const Hex& hex, std::vector<std::shared_ptr<Forest>>& forests);
-    bool isSurroundedByOtherPlayerEntities(const Hex& hex, const Player& currentPlayer, const int& currentLevel, const HexagonalGrid& grid, const GameEntities& gameEntities) const;
-    bool HexNotOnTerritoryAndAccessible(const std::shared_ptr<Entity>& entity, const Hex& targetHex, const HexagonalGrid& grid, size_t playerTurn, const GameEntities& gameEntities) const;
-    Hex randomfreeHex(const HexagonalGrid& grid, const GameEntities& gameEntities) const;
+    void generateEntities(const std::vector<std::string>& entityMap, const std::vector<std::string>& asciiMap, HexagonalGrid& grid, GameEntities& gameEntities, Random& random);
+    void upgradeEntity(HexagonalGrid& grid, const Hex& hex, GameEntities& gameEntities);
+    bool entityOnHex(const Hex& hex, const HexagonalGrid& grid) const;
+    void manageBandits(HexagonalGrid& grid, GameEntities& gameEntities, Random& random);
+    EntityHandle addNeutralEntity(HexagonalGrid& grid, GameEntities& gameEntities, EntityKind kind, const Hex& hex, int value = 0);
+    EntityHandle addPlayerEntity(HexagonalGrid& grid, GameEntities& gameEntities, Player& player, EntityKind kind, const Hex& hex);
+    void removeEntity(HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle entity);
+    void removeEntities(HexagonalGrid& grid, GameEntities& gameEntities, const std::vector<EntityHandle>& entities);
+    bool moveEntity(HexagonalGrid& grid, EntityStore& store, EntityHandle entity, const Hex& target) const;
+    bool occupancyMatchesEntities(const HexagonalGrid& grid, const GameEntities& gameEntities) const;
+    bool isSurroundedByOtherPlayerEntities(const Hex& hex, const Player& currentPlayer, const int& currentLevel, const HexagonalGrid& grid) const;
+    Hex randomfreeHex(const HexagonalGrid& grid, Random& random) const;
+
+    // Call fn(occupant) for every entity of a set of kinds standing within a distance of a hex,
+    // through the occupants of the grid: the cost depends on the radius, not on the number of entities
+    template <typename Function>
+    void forEachInRadius(const HexagonalGrid& grid, const Hex& hex, int radius, EntityKindSet kinds, Function fn) const {
+        grid.forEachCellInRadius(hex, radius, [&](int index) {
+            const HexOccupant& occupant = grid.getCellOccupant(index);
+            if (kinds & kindBit(occupant.kind)) {
+                fn(occupant);
+            }
+        });
+    }
 private:
-    void addEntityToPlayer(char entityType, const Hex& hex, std::shared_ptr<Player>& player);
-    void moveBanditToNewPosition(HexagonalGrid& grid, std::shared_ptr<Bandit>& bandit, const GameEntities& gameEntities);
-    void stealCoinFromPlayer(HexagonalGrid& grid, const std::shared_ptr<Bandit>& bandit, std::vector<std::shared_ptr<BanditCamp>>& banditCamps, const std::vector<std::shared_ptr<Player>>& players);
-    void spawnBanditFromCamp(HexagonalGrid& grid, std::shared_ptr<BanditCamp>& banditCamp, std::vector<std::shared_ptr<Bandit>>& bandits, const GameEntities& gameEntities);
-    bool banditCampNearBandit(const Hex& hex, const std::vector<std::shared_ptr<BanditCamp>>& banditCamps) const;
-    void spawnCampIfNeeded(HexagonalGrid& grid, const std::vector<std::shared_ptr<Bandit>>& bandits, GameEntities& gameEntities);
+    void placeEntity(HexagonalGrid& grid, EntityStore& store, EntityHandle entity, const Hex& target) const;
+    void addEntityToPlayer(HexagonalGrid& grid, GameEntities& gameEntities, char entityType, const Hex& hex, Player& player);
+    void moveBanditToNewPosition(HexagonalGrid& grid, EntityStore& store, EntityHandle bandit, Random& random);
+    void stealCoinFromPlayer(const HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle bandit);
+    void spawnBanditFromCamp(HexagonalGrid& grid, GameEntities& gameEntities, EntityHandle banditCamp, Random& random);
+    bool banditCampNearBandit(const Hex& hex, const HexagonalGrid& grid) const;
+    void spawnCampIfNeeded(HexagonalGrid& grid, GameEntities& gameEntities, Random& random);
+    void computeCampDistances(const HexagonalGrid& grid, const GameEntities& gameEntities);
+
+    // Distance field of the bandit camps, computed once at the start of the bandit phase
+    std::vector<int> campDistance; // Hex distance from each cell to the nearest camp, -1 if there is no camp
+    std::vector<int> nearestCamp;  // Index in the list of camps of the nearest camp of each cell, -1 if none
+    std::vector<int> campQueue;    // Cells in the order they were reached
 };
 
-#endif
\ No newline at end of file
+#endif
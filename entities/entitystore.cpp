@@ -0,0 +1,142 @@
+#include "entitystore.hpp"
+
+// Hex packed in one word for the journal, s is deduced from q and r
+static int64_t packHex(const Hex& hex) {
+    return (static_cast<int64_t>(hex.getQ()) << 32) | static_cast<uint32_t>(hex.getR());
+}
+
+static Hex unpackHex(int64_t bits) {
+    int q = static_cast<int32_t>(bits >> 32);
+    int r = static_cast<int32_t>(bits);
+    return Hex(q, r, -q - r);
+}
+
+EntityHandle EntityStore::create(EntityKind kind, const Hex& hex, OwnerId owner, int value) {
+    EntityHandle entity;
+    if (!freeSlots.empty()) {
+        entity.index = freeSlots.back();
+        record(JournalField::FreeSlotRemoved, entity.index, 0);
+        freeSlots.pop_back();
+    } else {
+        entity.index = static_cast<uint32_t>(kinds.size());
+        record(JournalField::EntitySlots, entity.index, static_cast<int64_t>(kinds.size()));
+        resizeSlots(kinds.size() + 1);
+    }
+    record(JournalField::EntityHex, entity.index, packHex(hexes[entity.index]));
+    hexes[entity.index] = hex;
+    record(JournalField::EntityKind, entity.index, static_cast<int64_t>(kinds[entity.index]));
+    kinds[entity.index] = kind;
+    record(JournalField::EntityOwner, entity.index, owners[entity.index]);
+    owners[entity.index] = owner;
+    record(JournalField::EntityValue, entity.index, values[entity.index]);
+    values[entity.index] = value;
+    record(JournalField::EntityMoved, entity.index, moved[entity.index]);
+    moved[entity.index] = false;
+    yOffsets[entity.index] = 0.0f;
+    previousYOffsets[entity.index] = 0.0f;
+    jumpSpeeds[entity.index] = 0.5f;
+    jumping[entity.index] = false;
+    falling[entity.index] = false;
+    entity.generation = generations[entity.index];
+    return entity;
+}
+
+void EntityStore::destroy(EntityHandle entity) {
+    if (!isAlive(entity)) {
+        return;
+    }
+    record(JournalField::EntityKind, entity.index, static_cast<int64_t>(kinds[entity.index]));
+    kinds[entity.index] = EntityKind::None;
+    record(JournalField::EntityGeneration, entity.index, generations[entity.index]);
+    generations[entity.index]++;
+    record(JournalField::FreeSlotAdded, entity.index, 0);
+    freeSlots.push_back(entity.index);
+}
+
+bool EntityStore::isAlive(EntityHandle entity) const {
+    return entity.index < kinds.size() && generations[entity.index] == entity.generation && kinds[entity.index] != EntityKind::None;
+}
+
+void EntityStore::setHex(EntityHandle entity, const Hex& hex) {
+    size_t index = slot(entity);
+    record(JournalField::EntityHex, entity.index, packHex(hexes[index]));
+    hexes[index] = hex;
+}
+
+void EntityStore::setMoved(EntityHandle entity, bool hasMoved) {
+    size_t index = slot(entity);
+    record(JournalField::EntityMoved, entity.index, moved[index]);
+    moved[index] = hasMoved;
+}
+
+void EntityStore::addValue(EntityHandle entity, int amount) {
+    size_t index = slot(entity);
+    record(JournalField::EntityValue, entity.index, values[index]);
+    values[index] += amount;
+}
+
+void EntityStore::record(JournalField field, uint32_t index, int64_t value) {
+    if (journal) {
+        journal->record({field, NEUTRAL_OWNER, static_cast<int>(index), value, 0});
+    }
+}
+
+void EntityStore::resizeSlots(size_t nbSlots) {
+    hexes.resize(nbSlots, Hex(0, 0, 0));
+    kinds.resize(nbSlots, EntityKind::None);
+    owners.resize(nbSlots, NEUTRAL_OWNER);
+    values.resize(nbSlots, 0);
+    moved.resize(nbSlots, false);
+    yOffsets.resize(nbSlots, 0.0f);
+    previousYOffsets.resize(nbSlots, 0.0f);
+    jumpSpeeds.resize(nbSlots, 0.5f);
+    jumping.resize(nbSlots, false);
+    falling.resize(nbSlots, false);
+    generations.resize(nbSlots, 0);
+}
+
+void EntityStore::applyJournalEntry(JournalEntry& entry) {
+    size_t index = static_cast<size_t>(entry.index);
+    int64_t current = 0;
+    switch (entry.field) {
+        case JournalField::EntitySlots:
+            current = static_cast<int64_t>(kinds.size());
+            resizeSlots(static_cast<size_t>(entry.value));
+            break;
+        case JournalField::FreeSlotAdded:
+            freeSlots.pop_back();
+            entry.field = JournalField::FreeSlotRemoved;
+            return;
+        case JournalField::FreeSlotRemoved:
+            freeSlots.push_back(entry.index);
+            entry.field = JournalField::FreeSlotAdded;
+            return;
+        case JournalField::EntityHex:
+            current = packHex(hexes[index]);
+            hexes[index] = unpackHex(entry.value);
+            break;
+        case JournalField::EntityKind:
+            current = static_cast<int64_t>(kinds[index]);
+            kinds[index] = static_cast<EntityKind>(entry.value);
+            break;
+        case JournalField::EntityOwner:
+            current = owners[index];
+            owners[index] = static_cast<OwnerId>(entry.value);
+            break;
+        case JournalField::EntityValue:
+            current = values[index];
+            values[index] = static_cast<int>(entry.value);
+            break;
+        case JournalField::EntityMoved:
+            current = moved[index];
+            moved[index] = static_cast<uint8_t>(entry.value);
+            break;
+        case JournalField::EntityGeneration:
+            current = generations[index];
+            generations[index] = static_cast<uint32_t>(entry.value);
+            break;
+        default:
+            throw std::invalid_argument("Not an entity store journal entry");
+    }
+    entry.value = current;
+}
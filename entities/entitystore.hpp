@@ -0,0 +1,111 @@
+#ifndef ENTITYSTORE_HPP
+#define ENTITYSTORE_HPP
+
+#include <algorithm>
+#include "entity.hpp"
+
+// Storage of every entity of a game, one array per field (structure of arrays).
+// Entities are referenced by generational handles: the slot of a destroyed entity is
+// reused by the next created one, the handles to the destroyed entity become stale.
+// The store has value semantics, copying a game copies its entities with the same handles.
+// When a journal is set, every change but the jump animation is recorded to be undone.
+class EntityStore {
+public:
+    // Create an entity, the value is the value of a treasure or the coins of a bandit camp
+    EntityHandle create(EntityKind kind, const Hex& hex, OwnerId owner = NEUTRAL_OWNER, int value = 0);
+
+    // Destroy an entity and free its slot
+    void destroy(EntityHandle entity);
+
+    // Check if a handle refers to an entity that has not been destroyed
+    bool isAlive(EntityHandle entity) const;
+
+    // Number of living entities
+    size_t size() const { return kinds.size() - freeSlots.size(); }
+
+    // Getters
+    Hex getHex(EntityHandle entity) const { return hexes[slot(entity)]; }
+    EntityKind getKind(EntityHandle entity) const { return kinds[slot(entity)]; }
+    OwnerId getOwner(EntityHandle entity) const { return owners[slot(entity)]; }
+    const EntityTraits& getTraits(EntityHandle entity) const { return entityTraits(getKind(entity)); }
+    std::string getName(EntityHandle entity) const { return getTraits(entity).name; }
+    Icon getIcon(EntityHandle entity) const { return getTraits(entity).icon; }
+    int getProtectionLevel(EntityHandle entity) const { return getTraits(entity).protection; }
+    int getUpkeep(EntityHandle entity) const { return getTraits(entity).upkeep; }
+    bool isBuilding(EntityHandle entity) const { return getTraits(entity).building; }
+    bool hasMoved(EntityHandle entity) const { return moved[slot(entity)]; }
+    int getValue(EntityHandle entity) const { return values[slot(entity)]; }
+    float getYOffset(EntityHandle entity) const { return yOffsets[slot(entity)]; }
+    // Offset drawn a fraction (0 to 1) of the way from the previous update of the animation to the last one
+    float getYOffset(EntityHandle entity, float alpha) const {
+        size_t index = slot(entity);
+        return previousYOffsets[index] + (yOffsets[index] - previousYOffsets[index]) * alpha;
+    }
+    float getJumpSpeed(EntityHandle entity) const { return jumpSpeeds[slot(entity)]; }
+    bool isJumping(EntityHandle entity) const { return jumping[slot(entity)]; }
+    bool isFalling(EntityHandle entity) const { return falling[slot(entity)]; }
+
+    // Setters (the hex of an entity standing on the grid is changed through the entity manager, which keeps the grid occupancy up to date)
+    void setHex(EntityHandle entity, const Hex& hex);
+    void setMoved(EntityHandle entity, bool hasMoved);
+    void addValue(EntityHandle entity, int amount);
+    void setYOffset(EntityHandle entity, float yOffset) { yOffsets[slot(entity)] = yOffset; }
+    void setJumpSpeed(EntityHandle entity, float jumpSpeed) { jumpSpeeds[slot(entity)] = jumpSpeed; }
+    void setJumping(EntityHandle entity, bool isJumping) { jumping[slot(entity)] = isJumping; }
+    void setFalling(EntityHandle entity, bool isFalling) { falling[slot(entity)] = isFalling; }
+    // Keep the offsets of every entity before an update of the animation changes them
+    void savePreviousYOffsets() { previousYOffsets = yOffsets; }
+
+    // Record the next changes in a journal (nullptr to stop recording)
+    void setJournal(Journal* journal) { this->journal = journal; }
+
+    // Undo or redo a change of the store recorded in the journal
+    void applyJournalEntry(JournalEntry& entry);
+
+private:
+    // Slot of a handle, checked against the generation of the slot in debug builds
+    size_t slot(EntityHandle entity) const {
+#ifdef KONKR_DEBUG
+        assert(isAlive(entity));
+#endif
+        return entity.index;
+    }
+
+    // Record the value of a column of a slot before it changes
+    void record(JournalField field, uint32_t index, int64_t value);
+
+    // Grow or shrink every column to a number of slots
+    void resizeSlots(size_t nbSlots);
+
+    std::vector<Hex> hexes;
+    std::vector<EntityKind> kinds;      // EntityKind::None for free slots
+    std::vector<OwnerId> owners;        // NEUTRAL_OWNER for bandits, bandit camps, treasures, devils and forests
+    std::vector<int> values;            // Value of a treasure, coins of a bandit camp
+    std::vector<uint8_t> moved;
+    std::vector<float> yOffsets;        // Jump animation of the units waiting to be moved
+    std::vector<float> previousYOffsets;
+    std::vector<float> jumpSpeeds;
+    std::vector<uint8_t> jumping;
+    std::vector<uint8_t> falling;
+    std::vector<uint32_t> generations;  // Incremented each time the entity of a slot is destroyed
+    std::vector<uint32_t> freeSlots;
+    Journal* journal = nullptr;
+};
+
+// Remove some entities from a list of handles in one pass, keeping the order of the others.
+// record(position, entity) is called for each removed entity from the last to the first,
+// the positions are those of erasing them one by one so that undo inserts them back in order.
+template <typename Record>
+void removeEntitiesFromList(std::vector<EntityHandle>& entities, std::vector<EntityHandle> removed, Record record) {
+    auto before = [](EntityHandle a, EntityHandle b) { return a.toBits() < b.toBits(); };
+    std::sort(removed.begin(), removed.end(), before);
+    auto isRemoved = [&](EntityHandle entity) { return std::binary_search(removed.begin(), removed.end(), entity, before); };
+    for (size_t i = entities.size(); i-- > 0;) {
+        if (isRemoved(entities[i])) {
+            record(static_cast<int>(i), entities[i]);
+        }
+    }
+    entities.erase(std::remove_if(entities.begin(), entities.end(), isRemoved), entities.end());
+}
+
+#endif // ENTITYSTORE_HPP
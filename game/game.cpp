@@ -1,21 +1,8 @@
 #include "game.hpp"
 
-// Custom comparison function for SDL_Color
-struct SDL_Color_Compare {
-    bool operator()(const SDL_Color& a, const SDL_Color& b) const {
-        if (a.r != b.r) return a.r < b.r;
-        if (a.g != b.g) return a.g < b.g;
-        if (a.b != b.b) return a.b < b.b;
-        return a.a < b.a;
-    }
-};
-
-Game::Game(double hexSize, const std::vector<std::string>& asciiMap, std::vector<std::string>& entityMap,
+Game::Game(double hexSize, const std::vector<std::string>& asciiMap, const std::vector<std::string>& entityMap, uint64_t seed,
         int windowWidth, int windowHeight, SDL_Renderer* renderer, int cameraSpeed)
-    : grid(hexSize),
-    playerTurn(0),
-    entitySelected(false),
-    selectedEntityIndex(-1),
+    : engine(hexSize, asciiMap, entityMap, seed),
     turnButton(0, 0, 0, 0, "", 0),
     undoButton(0, 0, 0, 0, "", 0),
     quitButton(0, 0, 0, 0, "", 0),
@@ -23,67 +10,32 @@ Game::Game(double hexSize, const std::vector<std::string>& asciiMap, std::vector
     draggedButton(nullptr),
     cameraSpeed(cameraSpeed),
     endGame(false),
+    buttonHovered(false),
     hoveredButton(0, 0, 0, 0, "", 0),
-    defaultHexSize(hexSize)
+    defaultHexSize(hexSize),
+    dirty(true),
+    animating(false)
 {
     std::cout << "Game constructor started" << std::endl;
-    turn = 0;
 
     cameraX = 0;
     cameraY = 0;
-    // Load all textures from the icons directory
+    // Load all icons from the icons directory into one texture
     std::cout << "Loading textures..." << std::endl;
-    std::string iconsPath = "icons/";
-    for (const auto& filename : iconNames) {
-        std::string path = iconsPath + filename + ".png";
-        SDL_Texture* texture = IMG_LoadTexture(renderer, path.c_str());
-        if (!texture) {
-            std::cerr << "Error loading texture: " << IMG_GetError() << std::endl;
-        }
-        textures.push_back(texture);
+    if (icons.load(renderer, "icons/")) {
+        std::cout << "Textures loaded: " << NB_ICONS << std::endl;
     }
-    std::cout << "Textures loaded: " << textures.size() << std::endl;
 
-    std::cout << "Generating grid..." << std::endl;
-    grid.generateFromASCII(asciiMap, windowWidth, windowHeight);
+    // The engine prints nothing, the frontend reports what it generated
     std::cout << "Grid generated" << std::endl;
-
-    // Count the number of unique colors in the grid and create players
-    nbplayers = 0;
-    std::vector<SDL_Color> uniqueColors;
-    for (const auto& pair : grid.getHexColors()) {
-        const SDL_Color& color = pair.second;
-        bool found = false;
-        for (const auto& uniqueColor : uniqueColors) {
-            if (color == uniqueColor) {
-                found = true;
-                break;
-            }
-        }
-        if (!found && !(color == defaultColor)) {
-            nbplayers++;
-            gameEntities.players.emplace_back(std::make_shared<Player>(color));
-            uniqueColors.push_back(color);
-        }
-    }
-    std::cout << "Number of players: " << nbplayers << std::endl;
-
-    if(nbplayers == 0) {
+    std::cout << "Number of players: " << engine.getNbPlayers() << std::endl;
+    engine.getGrid().centerOn(windowWidth, windowHeight);
+    if(engine.getNbPlayers() == 0) {
         std::cerr << "Error : Need at least one player" << std::endl;
         endGame = true;
         return;
     }
-
-    // Create a map to store hexes by color
-    std::map<SDL_Color, std::vector<Hex>, SDL_Color_Compare> hexesByColor;
-    for (const auto& pair : grid.getHexColors()) {
-        SDL_Color color = pair.second;
-        hexesByColor[color].push_back(pair.first);
-    }
-
-    // Generate entities based on the entityMap
-    std::cout << "Generating entities..." << std::endl;
-    entityManager.generateEntities(entityMap, asciiMap, grid, gameEntities);
+    std::cout << "Entities generated: " << engine.getGameEntities().store.size() << std::endl;
 
     int nbButtons = 5;
     int buttonSize = 50;
@@ -92,11 +44,12 @@ Game::Game(double hexSize, const std::vector<std::string>& asciiMap, std::vector
     int startX = (windowWidth - totalWidth) / 2;
     int buttonY = windowHeight - buttonSize - 20 - buttonSpacing;
 
-    unitButtons.emplace_back(startX, buttonY, buttonSize, buttonSize, "villager", 10);
-    unitButtons.emplace_back(startX + buttonSize + buttonSpacing, buttonY, buttonSize, buttonSize, "pikeman", 20);
-    unitButtons.emplace_back(startX + 2 * (buttonSize + buttonSpacing), buttonY, buttonSize, buttonSize, "knight", 40);
-    unitButtons.emplace_back(startX + 3 * (buttonSize + buttonSpacing), buttonY, buttonSize, buttonSize, "hero", 80);
-    unitButtons.emplace_back(startX + 4 * (buttonSize + buttonSpacing), buttonY, buttonSize, buttonSize, "castle", 20);
+    // The cost shown on a button is the one paid by the engine
+    int i = 0;
+    for (const char* name : {"villager", "pikeman", "knight", "hero", "castle"}) {
+        unitButtons.emplace_back(startX + i * (buttonSize + buttonSpacing), buttonY, buttonSize, buttonSize, name, entityTraits(entityKindFromName(name)).cost);
+        i++;
+    }
 
     // Create buttons for turn, undo, quit, and replay
     int turnButtonWidth = buttonSize * 3;
@@ -106,139 +59,48 @@ Game::Game(double hexSize, const std::vector<std::string>& asciiMap, std::vector
     replayButton = Button(windowWidth - turnButtonWidth- 20, windowHeight - buttonSize - 20, turnButtonWidth, buttonSize, "replay", 0);
 }
 
-Game::Game(const Game& other)
-    : grid(other.grid),
-      gameEntities(),
-      playerTurn(other.playerTurn),
-      entitySelected(other.entitySelected),
-      textures(other.textures),
-      selectedEntityIndex(other.selectedEntityIndex),
-      nbplayers(other.nbplayers),
-      turn(other.turn),
-      unitButtons(other.unitButtons),
-      turnButton(other.turnButton),
-      undoButton(other.undoButton),
-      quitButton(other.quitButton),
-      replayButton(other.replayButton),
-      draggedButton(nullptr),
-      cameraX(other.cameraX),     
-      cameraY(other.cameraY),
-      cameraSpeed(other.cameraSpeed),
-      hoveredButton(other.hoveredButton)
-{
-    // Copy players
-    for (const auto& player : other.gameEntities.players) {
-        gameEntities.players.push_back(std::make_shared<Player>(*player));
-    }
-
-    // Copy bandits
-    for (const auto& bandit : other.gameEntities.bandits) {
-        gameEntities.bandits.push_back(std::make_shared<Bandit>(*bandit));
-    }
-
-    // Copy banditCamps
-    for (const auto& banditCamp : other.gameEntities.banditCamps) {
-        gameEntities.banditCamps.push_back(std::make_shared<BanditCamp>(*banditCamp));
-    }
-
-    // Copy treasures
-    for (const auto& treasure : other.gameEntities.treasures) {
-        gameEntities.treasures.push_back(std::make_shared<Treasure>(*treasure));
-    }
-
-    // Copy devils
-    for (const auto& devil : other.gameEntities.devils) {
-        gameEntities.devils.push_back(std::make_shared<Devil>(*devil));
+void Game::handleEvent(SDL_Event& event) {
+    // Any event but a mouse motion may change the frame, a motion only when it drags the selected entity or changes the hovered button.
+    // The other motions only look for the hovered button, they come by hundreds and are not traced.
+    bool changesFrame = event.type != SDL_MOUSEMOTION || engine.isEntitySelected();
+    ScopedTrace trace("handle event", changesFrame);
+    if (changesFrame) {
+        dirty = true;
     }
 
-    // Copy forests
-    for (const auto& forest : other.gameEntities.forests) {
-        gameEntities.forests.push_back(std::make_shared<Forest>(*forest));
+    // The terrain layer is painted again when the renderer loses its render targets (e.g. a Direct3D device reset)
+    if (event.type == SDL_RENDER_TARGETS_RESET) {
+        renderGame.invalidateTerrain();
+        return;
     }
-}
-
-Game& Game::operator=(const Game& other) {
-    if (this != &other) {
-        grid = other.grid;
-        playerTurn = other.playerTurn;
-        entitySelected = other.entitySelected;
-        selectedEntityIndex = other.selectedEntityIndex;
-        textures = other.textures;
-        nbplayers = other.nbplayers;
-        turn = other.turn;
-        unitButtons = other.unitButtons;
-        turnButton = other.turnButton;
-        undoButton = other.undoButton;
-        quitButton = other.quitButton;
-        replayButton = other.replayButton;
-        draggedButton = nullptr;
-        cameraX = other.cameraX;
-        cameraY = other.cameraY;
-        cameraSpeed = other.cameraSpeed;
-
-        // Copy players
-        gameEntities.players.clear();
-        for (const auto& player : other.gameEntities.players) {
-            gameEntities.players.push_back(std::make_shared<Player>(*player));
-        }
-
-        // Copy bandits
-        gameEntities.bandits.clear();
-        for (const auto& bandit : other.gameEntities.bandits) {
-            gameEntities.bandits.push_back(std::make_shared<Bandit>(*bandit));
-        }
 
-        // Copy banditCamps
-        gameEntities.banditCamps.clear();
-        for (const auto& banditCamp : other.gameEntities.banditCamps) {
-            gameEntities.banditCamps.push_back(std::make_shared<BanditCamp>(*banditCamp));
-        }
-
-        // Copy treasures
-        gameEntities.treasures.clear();
-        for (const auto& treasure : other.gameEntities.treasures) {
-            gameEntities.treasures.push_back(std::make_shared<Treasure>(*treasure));
-        }
-
-        // Copy devils
-        gameEntities.devils.clear();
-        for (const auto& devil : other.gameEntities.devils) {
-            gameEntities.devils.push_back(std::make_shared<Devil>(*devil));
-        }
-
-        // Copy forests
-        gameEntities.forests.clear();
-        for (const auto& forest : other.gameEntities.forests) {
-            gameEntities.forests.push_back(std::make_shared<Forest>(*forest));
-        }
+    if (engine.getNbPlayers() == 1
+        && (event.type == SDL_MOUSEBUTTONDOWN && replayButton.containsPoint(event.button.x, event.button.y))) {
+        restart();
+        return;
     }
-    return *this;
-}
 
-Game::~Game() {
-    for (SDL_Texture* texture : textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
+    if (engine.getNbPlayers() == 1
+        && (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_e)) {
+        restart();
+        return;
     }
-}
 
-void Game::handleEvent(SDL_Event& event) {
-
-    if (nbplayers == 1
-        && (event.type == SDL_MOUSEBUTTONDOWN && replayButton.containsPoint(event.button.x, event.button.y))) {
-        replayButtonClicked = true;
+    // Undo with the undo button, backspace or 'R', redo with 'Y'
+    if ((event.type == SDL_MOUSEBUTTONDOWN && undoButton.containsPoint(event.button.x, event.button.y))
+        || (event.type == SDL_KEYDOWN && (event.key.keysym.sym == SDLK_BACKSPACE || event.key.keysym.sym == SDLK_r))) {
+        undoTurn();
         return;
     }
 
-    if (nbplayers == 1
-        && (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_e)) {
-        replayButtonClicked = true;
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_y) {
+        redoTurn();
         return;
     }
 
-    if (event.type == SDL_MOUSEBUTTONDOWN && undoButton.containsPoint(event.button.x, event.button.y)) {
-        undo = true;
+    // Show or hide the profiler, it only measures while it is shown
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+        profiler.setEnabled(!profiler.isEnabled());
         return;
     }
 
@@ -249,163 +111,12 @@ void Game::handleEvent(SDL_Event& event) {
 
     // if 'E' is pressed or turnbutton clicked, change player
     if ((event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_e)
-        || (event.type == SDL_MOUSEBUTTONDOWN && turnButton.containsPoint(event.button.x, event.button.y) && !entitySelected)) {
-
-        // if entities on hex not existing on the grid refund the cost of the entity
-        if(entitySelected) {
-            auto& entity = gameEntities.players[playerTurn]->getEntities()[selectedEntityIndex];
-            Hex entityHex = entity->getHex();
-            if(!(grid.hexExists(entityHex))) {
-                gameEntities.players[playerTurn]->removeEntity(entity);
-                // refund the cost of the entity
-                for(auto& button : unitButtons) {
-                    if(button.getIconName() == entity->getName()) {
-                        gameEntities.players[playerTurn]->addCoins(button.getCost());
-                    }
-                }
-            }
-        }
-        selectedEntityIndex = -1;
-        entitySelected = false;
-
-        for(auto& player : gameEntities.players) {
-            playerManager.checkIfHexConnectedToTown(*player, grid, gameEntities.bandits, gameEntities.banditCamps);
-        }
-
-        // Remove dead players
-        std::vector<std::shared_ptr<Player>> toRemove;
-        for (auto& player : gameEntities.players) {
-            if (player->isTownDestroyed() && player->isAlive()) {
-                toRemove.push_back(player);
-            }
-        }
-        for (auto& player : toRemove) {
-            playerManager.removePlayer(player, nbplayers, gameEntities.bandits, gameEntities.banditCamps);
-        }
-        // Change player
-        playerTurn = (playerTurn + 1) % gameEntities.players.size();
-        while(!gameEntities.players[playerTurn]->isAlive()) {
-            playerTurn = (playerTurn + 1) % gameEntities.players.size();
-        }
-
-        auto& currentPlayer = gameEntities.players[playerTurn];
-
-        // BANDIT, TREASURE AND DEVIL ACTIONS HERE
-        if (playerTurn == 0) {
-            turn++;
-            if(turn > 0) {
-                entityManager.manageBandits(grid, gameEntities);
-            }
-            if(gameEntities.treasures.empty()) {
-                int treasureValue = std::rand() % 10 + 1;
-                if(std::rand() % 4 == 0) {
-                    Hex treasureHex = entityManager.randomfreeHex(grid, gameEntities);
-                    if(treasureHex.getQ() != -1000 && treasureHex.getR() != 0 && treasureHex.getS() != 1000) {
-                        entityManager.addTreasure(treasureHex, treasureValue, gameEntities.treasures);
-                    }
-                }
-            }
-
-            if (gameEntities.devils.empty()) {
-                if(std::rand() % 1000 == 0) {
-                    Hex devilHex = entityManager.randomfreeHex(grid, gameEntities);
-                    if(devilHex.getQ() != -1000 && devilHex.getR() != 0 && devilHex.getS() != 1000) {
-                        entityManager.addDevil(devilHex, gameEntities.devils);
-                        // kill all the entities around the devil
-                        for(auto& player : gameEntities.players) {
-                            std::vector<std::shared_ptr<Entity>> entitiesToRemove;
-                            for(auto& entity : player->getEntities()) {
-                                if(entity->getHex().distance(devilHex) <= 1 && entity->getName() != "town" && entity->getProtectionLevel() <= 2) {
-                                    entitiesToRemove.push_back(entity);
-                                }
-                            }
-                            for(auto& entity : entitiesToRemove) {
-                                player->removeEntity(entity);
-                            }
-                        }
-                        // remove all the bandits around the devil
-                        std::vector<std::shared_ptr<Bandit>> banditsToRemove;
-                        for(auto& bandit : gameEntities.bandits) {
-                            if(bandit->getHex().distance(devilHex) <= 1) {
-                                banditsToRemove.push_back(bandit);
-                            }
-                        }
-                        for(auto& bandit : banditsToRemove) {
-                            gameEntities.bandits.erase(std::remove(gameEntities.bandits.begin(), gameEntities.bandits.end(), bandit), gameEntities.bandits.end());
-                        }
-                        // remove all the bandit camps around the devil
-                        std::vector<std::shared_ptr<BanditCamp>> banditCampsToRemove;
-                        for(auto& banditcamp : gameEntities.banditCamps) {
-                            if(banditcamp->getHex().distance(devilHex) <= 1) {
-                                banditCampsToRemove.push_back(banditcamp);
-                            }
-                        }
-                        for(auto& banditcamp : banditCampsToRemove) {
-                            gameEntities.banditCamps.erase(std::remove(gameEntities.banditCamps.begin(), gameEntities.banditCamps.end(), banditcamp), gameEntities.banditCamps.end());
-                        }
-                        // remove all the treasures around the devil
-                        std::vector<std::shared_ptr<Treasure>> treasuresToRemove;
-                        for(auto& treasure : gameEntities.treasures) {
-                            if(treasure->getHex().distance(devilHex) <= 1) {
-                                treasuresToRemove.push_back(treasure);
-                            }
-                        }
-                        for(auto& treasure : treasuresToRemove) {
-                            gameEntities.treasures.erase(std::remove(gameEntities.treasures.begin(), gameEntities.treasures.end(), treasure), gameEntities.treasures.end());
-                        }
-                    }
-                }
-            } else {
-                // remove all the devils
-                for(auto& devil : gameEntities.devils) {
-                    gameEntities.devils.erase(std::remove(gameEntities.devils.begin(), gameEntities.devils.end(), devil), gameEntities.devils.end());
-                }
-
-            }
-        }
-
-        // END OF BANDIT, TREASURE AND DEVIL ACTIONS
-
-        if(turn > 0) {
-            // Add land income based on the number of hexes owned by the current player
-            currentPlayer->addCoins(grid.getNbCasesColor(currentPlayer->getColor()));
-
-            // Prepare entities for the next turn and handle upkeep costs
-            std::vector<std::shared_ptr<Entity>> entitiesToRemove;
-            for(auto& entity : currentPlayer->getEntities()) {
-            bool isBuilding = dynamic_cast<Building*>(entity.get());
-
-            // Reset movement for non-building entities if there are multiple players
-            if(!isBuilding && gameEntities.players.size() > 1) {
-                entity->setMoved(false);
-            }
-
-            int upkeepCost = entity->getUpkeep();
-
-            // Deduct upkeep cost or replace the entity with a bandit/bandit camp if insufficient funds
-            if(currentPlayer->getCoins() >= upkeepCost) {
-                currentPlayer->removeCoins(upkeepCost);
-            } else {
-                Hex entityHex = entity->getHex();
-                if(isBuilding) {
-                // Replace building with a bandit camp
-                entityManager.addBanditCamp(entityHex, gameEntities.banditCamps);
-                } else {
-                // Replace unit with a bandit
-                entityManager.addBandit(entityHex, gameEntities.bandits);
-                }
-                entitiesToRemove.push_back(entity);
-            }
-            }
-
-            // Remove entities that couldn't pay their upkeep
-            for(auto& entity : entitiesToRemove) {
-            currentPlayer->removeEntity(entity);
-            }
-        }
+        || (event.type == SDL_MOUSEBUTTONDOWN && turnButton.containsPoint(event.button.x, event.button.y) && !engine.isEntitySelected())) {
+        engine.endTurn();
     }
 
     if (event.type == SDL_MOUSEWHEEL) {
+        HexagonalGrid& grid = engine.getGrid();
         int hexSize = grid.getHexSize();
         int minimumZoom = 10;
         int camCompensation = 9; // value found by trial and error
@@ -422,7 +133,7 @@ void Game::handleEvent(SDL_Event& event) {
 
     // reset camera zoom and position if space is pressed
     if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
-        grid.setHexSize(defaultHexSize);
+        engine.getGrid().setHexSize(defaultHexSize);
         cameraX = 0;
         cameraY = 0;
     }
@@ -462,185 +173,40 @@ void Game::handleEvent(SDL_Event& event) {
     if (event.type == SDL_MOUSEBUTTONDOWN || entityToBuy != "") {
         int mouseX, mouseY;
         SDL_GetMouseState(&mouseX, &mouseY);
+        const HexagonalGrid& grid = engine.getGrid();
         Hex clickedHex = grid.pixelToHex(mouseX, mouseY, cameraX, cameraY);
 
         if(entityToBuy != "") clickedHex = grid.pixelToHex(0, 0, cameraX, cameraY);
 
         // Check if a button was clicked
         for (auto& button : unitButtons) {
-            if ((button.containsPoint(mouseX, mouseY) || button.getIconName() == entityToBuy)&& !entitySelected) {
-                if (button.getCost() <= gameEntities.players[playerTurn]->getCoins()) {
-                    if (button.getIconName() == "villager") {
-                        gameEntities.players[playerTurn]->addEntity(std::make_shared<Villager>(clickedHex));
-                    } else if (button.getIconName() == "pikeman") {
-                        gameEntities.players[playerTurn]->addEntity(std::make_shared<Pikeman>(clickedHex));
-                    } else if (button.getIconName() == "knight") {
-                        gameEntities.players[playerTurn]->addEntity(std::make_shared<Knight>(clickedHex));
-                    } else if (button.getIconName() == "hero") {
-                        gameEntities.players[playerTurn]->addEntity(std::make_shared<Hero>(clickedHex));
-                    } else if(button.getIconName() == "castle") {
-                        gameEntities.players[playerTurn]->addEntity(std::make_shared<Castle>(clickedHex));
-                        gameEntities.players[playerTurn]->getEntities().back()->setMoved(false);
-                    }
-                    gameEntities.players[playerTurn]->removeCoins(button.getCost());
-                }
+            if (button.containsPoint(mouseX, mouseY) || button.getIconName() == entityToBuy) {
+                engine.buyEntity(entityKindFromName(button.getIconName()), clickedHex);
             }
         }
 
-
-        if (playerTurn < gameEntities.players.size()) {
-            if (!entitySelected) {
-                auto& currentPlayer = gameEntities.players[playerTurn];
-                const auto& playerEntities = currentPlayer->getEntities();
-
-                for (size_t i = 0; i < playerEntities.size(); ++i) {
-                    if (!playerEntities[i]->hasMoved() && playerEntities[i]->getHex() == clickedHex) {
-                        if(dynamic_cast<Building*>(playerEntities[i].get()) && grid.hexExists(clickedHex)) {
-                            continue;
-                        }
-                        selectedEntityIndex = i;
-                        entitySelected = true;
-                        break;
-                    }
-                }
-            } else if (entityToBuy == "") {
-                bool moveSuccessful = false;
-                if (grid.hexExists(clickedHex)) {
-                    auto& currentPlayer = gameEntities.players[playerTurn];
-                    auto entity = currentPlayer->getEntities()[selectedEntityIndex];
-                    SDL_Color targetColor = grid.getHexColors().at(clickedHex);
-
-                    if ((entity) &&
-                        !entityManager.isSurroundedByOtherPlayerEntities(clickedHex, *currentPlayer, entity->getProtectionLevel(), grid, gameEntities) &&
-                        playerManager.hasSamePlayerEntities(clickedHex, *currentPlayer) == "") {
-                        if(entity->getName() == "castle" && !entityManager.entityOnHex(clickedHex, gameEntities) && grid.getHexColors().at(clickedHex) == currentPlayer->getColor()) {
-                            entity->setHex(clickedHex);
-                            entity->setMoved(true);
-                        }
-
-                        moveSuccessful = entity->move(grid, clickedHex, currentPlayer->getColor());
-
-                        // We flag the entity as moved if the move was successful
-                        if (moveSuccessful) {
-                            bool movedOnSameColor = targetColor == currentPlayer->getColor();
-
-                            // remove potential bandits on the hex we are moving to
-                            for (auto& bandit : gameEntities.bandits) {
-                                if (bandit->getHex() == clickedHex) {
-                                    gameEntities.bandits.erase(std::remove(gameEntities.bandits.begin(), gameEntities.bandits.end(), bandit), gameEntities.bandits.end());
-                                    entity->setMoved(true);
-                                    break;
-                                }
-                            }
-
-                            // remove potential bandit camps on the hex we are moving to
-                            for (auto& banditcamp : gameEntities.banditCamps) {
-                                if (banditcamp->getHex() == clickedHex) {
-                                    gameEntities.banditCamps.erase(std::remove(gameEntities.banditCamps.begin(), gameEntities.banditCamps.end(), banditcamp), gameEntities.banditCamps.end());
-                                    entity->setMoved(true);
-                                    break;
-                                }
-                            }
-
-                            if(!movedOnSameColor) {
-                                entity->setMoved(true);
-                                // remove potential entity on the hex we are moving to
-                                for (auto& player : gameEntities.players) {
-                                    if (player->getColor() == currentPlayer->getColor()) {
-                                        continue;
-                                    }
-                                    for (auto& entity : player->getEntities()) {
-                                        if (entity->getHex() == clickedHex) {
-                                            if (entity->getName() == "town") {
-                                                player->setTownDestroyed(true);
-                                                int coinsOfDeadPlayer = player->getCoins();
-                                                currentPlayer->addCoins(coinsOfDeadPlayer);
-                                            }
-                                            player->removeEntity(entity);
-                                            break;
-                                        }
-                                    }
-                                }
-                                // check if a player is on a treasure, give the coins to the player and remove the treasure
-                                for(auto& treasure : gameEntities.treasures) {
-                                    for (auto& player : gameEntities.players) {
-                                        for (auto& entity : player->getEntities()) {
-                                            if(treasure->getHex() == entity->getHex()) {
-                                                player->addCoins(treasure->getValue());
-                                                gameEntities.treasures.erase(std::remove(gameEntities.treasures.begin(), gameEntities.treasures.end(), treasure), gameEntities.treasures.end());
-                                                break;
-                                            }
-                                        }
-                                    }
-                                }
-
-                                // check if a player beat the devil, give the coins to the player and remove the devil
-                                for(auto& devil : gameEntities.devils) {
-                                    for (auto& player : gameEntities.players) {
-                                        for (auto& entity : player->getEntities()) {
-                                            if(devil->getHex() == entity->getHex()) {
-                                                player->addCoins(devil->getUpkeep());
-                                                gameEntities.devils.erase(std::remove(gameEntities.devils.begin(), gameEntities.devils.end(), devil), gameEntities.devils.end());
-                                                break;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        } else {
-                            if(!(grid.hexExists(entity->getHex()))) {
-                                currentPlayer->removeEntity(entity);
-                                // refund the cost of the entity
-                                for(auto& button : unitButtons) {
-                                    if(button.getIconName() == entity->getName()) {
-                                        currentPlayer->addCoins(button.getCost());
-                                    }
-                                }
-                            }
-                        }
-                    } else if (entity && !(entity->getHex() == clickedHex) && entity->getName() == playerManager.hasSamePlayerEntities(clickedHex, *currentPlayer) && entity->getName() != "hero" && entity->getName() != "castle") {
-                        currentPlayer->removeEntity(entity);
-                        entityManager.upgradeEntity(clickedHex, gameEntities.players);
-                    } else if(entity && !grid.hexExists(entity->getHex())) {
-                        currentPlayer->removeEntity(entity);
-                        // refund the cost of the entity
-                        for(auto& button : unitButtons) {
-                            if(button.getIconName() == entity->getName()) {
-                                currentPlayer->addCoins(button.getCost());
-                            }
-                        }
-                    }
-                } else {
-                    // handle when the hex in question is on a button (then doesnt exist)
-                    auto& entity = gameEntities.players[playerTurn]->getEntities()[selectedEntityIndex];
-                    Hex entityHex = entity->getHex();
-                    if(!(grid.hexExists(entityHex))) {
-                        gameEntities.players[playerTurn]->removeEntity(entity);
-                        // refund the cost of the entity
-                        for(auto& button : unitButtons) {
-                            if(button.getIconName() == entity->getName()) {
-                                gameEntities.players[playerTurn]->addCoins(button.getCost());
-                            }
-                        }
-                    }
-                }
-                entitySelected = false;
-                selectedEntityIndex = -1;
-            }
+        if (!engine.isEntitySelected()) {
+            engine.selectEntity(clickedHex);
+        } else if (entityToBuy == "") {
+            engine.moveSelectedEntity(clickedHex);
         }
     } else if (event.type == SDL_MOUSEMOTION) {
         int mouseX, mouseY;
         SDL_GetMouseState(&mouseX, &mouseY);
     }
 
-    if (event.type == SDL_MOUSEBUTTONDOWN && turnButton.containsPoint(event.button.x, event.button.y)) {
-        turnButtonClicked = true;
+    // The state reached at the end of a turn is where undo and redo stop
+    if ((event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_e)
+        || (event.type == SDL_MOUSEBUTTONDOWN && turnButton.containsPoint(event.button.x, event.button.y))) {
+        engine.saveCheckpoint();
         return;
     }
 
     if (event.type == SDL_MOUSEMOTION) {
         int mouseX, mouseY;
         SDL_GetMouseState(&mouseX, &mouseY);
+        bool wasHovered = buttonHovered;
+        std::string previousIconName = hoveredButton.getIconName();
         buttonHovered = false;
         for(auto unitButton : unitButtons) {
             if(unitButton.containsPoint(mouseX, mouseY)) {
@@ -648,9 +214,28 @@ void Game::handleEvent(SDL_Event& event) {
                 hoveredButton = unitButton;
             }
         }
+        if (buttonHovered != wasHovered || (buttonHovered && hoveredButton.getIconName() != previousIconName)) {
+            dirty = true;
+        }
     }
 }
 
+void Game::undoTurn() {
+    engine.undoTurn();
+    draggedButton = nullptr;
+}
+
+void Game::redoTurn() {
+    engine.redoTurn();
+    draggedButton = nullptr;
+}
+
+void Game::restart() {
+    engine.restart();
+    draggedButton = nullptr;
+    endGame = false;
+}
+
 void Game::update() {
     const float initjumpSpeed = 0.25f;
     const float maxJumpHeight = 5.0f;
@@ -658,14 +243,18 @@ void Game::update() {
     const float jumpSpeedDecrease = initjumpSpeed / 50.0f;
     const float jumpSpeedIncrease = jumpSpeedDecrease;
 
+    GameEntities& gameEntities = engine.getGameEntities();
+    EntityStore& store = gameEntities.store;
+    store.savePreviousYOffsets();
+    animating = false;
     for (auto& player : gameEntities.players) {
-        if (player != gameEntities.players[playerTurn]) {
-            for (auto& entity : player->getEntities()) {
-                if (!entity->hasMoved() && !dynamic_cast<Building*>(entity.get())) {
-                    entity->setYOffset(minJumpHeight);
-                    entity->setJumping(false);
-                    entity->setFalling(false);
-                    entity->setJumpSpeed(initjumpSpeed);
+        if (player != gameEntities.players[engine.getPlayerTurn()]) {
+            for (EntityHandle entity : player->getEntities()) {
+                if (!store.hasMoved(entity) && !store.isBuilding(entity)) {
+                    store.setYOffset(entity, minJumpHeight);
+                    store.setJumping(entity, false);
+                    store.setFalling(entity, false);
+                    store.setJumpSpeed(entity, initjumpSpeed);
                 }
             }
             continue;
@@ -673,84 +262,106 @@ void Game::update() {
         float syncY = 0.0f;
         bool foundSync = false;
 
-        for (auto& entity : player->getEntities()) {
-            if (entity->hasMoved() || dynamic_cast<Building*>(entity.get())) {
-                entity->setYOffset(minJumpHeight);
-                entity->setJumping(false);
-                entity->setFalling(false);
-                entity->setJumpSpeed(initjumpSpeed);
-                if (entity->getYOffset() > minJumpHeight) {
-                    entity->setYOffset(minJumpHeight);
-                }
+        for (EntityHandle entity : player->getEntities()) {
+            if (store.hasMoved(entity) || store.isBuilding(entity)) {
+                store.setYOffset(entity, minJumpHeight);
+                store.setJumping(entity, false);
+                store.setFalling(entity, false);
+                store.setJumpSpeed(entity, initjumpSpeed);
                 continue;
             }
 
             if (!foundSync) {
                 foundSync = true;
+                animating = true;
 
-                if (!entity->isJumping() && !entity->isFalling()) {
-                    entity->setJumping(true);
-                    entity->setJumpSpeed(initjumpSpeed);
+                if (!store.isJumping(entity) && !store.isFalling(entity)) {
+                    store.setJumping(entity, true);
+                    store.setJumpSpeed(entity, initjumpSpeed);
                 }
 
-                if (entity->isJumping()) {
-                    entity->setYOffset(entity->getYOffset() + entity->getJumpSpeed());
-                    entity->setJumpSpeed(entity->getJumpSpeed() - jumpSpeedDecrease);
+                if (store.isJumping(entity)) {
+                    store.setYOffset(entity, store.getYOffset(entity) + store.getJumpSpeed(entity));
+                    store.setJumpSpeed(entity, store.getJumpSpeed(entity) - jumpSpeedDecrease);
 
-                    if (entity->getYOffset() > maxJumpHeight) {
-                        entity->setJumping(false);
-                        entity->setFalling(true);
-                        entity->setYOffset(maxJumpHeight);
+                    if (store.getYOffset(entity) > maxJumpHeight) {
+                        store.setJumping(entity, false);
+                        store.setFalling(entity, true);
+                        store.setYOffset(entity, maxJumpHeight);
                     }
-                } else if (entity->isFalling()) {
-                    entity->setJumpSpeed(std::min(entity->getJumpSpeed() + jumpSpeedIncrease, initjumpSpeed));
-                    entity->setYOffset(entity->getYOffset() - entity->getJumpSpeed());
-
-                    if (entity->getYOffset() <= minJumpHeight) {
-                        entity->setFalling(false);
-                        entity->setJumping(true);
-                        entity->setYOffset(minJumpHeight);
+                } else if (store.isFalling(entity)) {
+                    store.setJumpSpeed(entity, std::min(store.getJumpSpeed(entity) + jumpSpeedIncrease, initjumpSpeed));
+                    store.setYOffset(entity, store.getYOffset(entity) - store.getJumpSpeed(entity));
+
+                    if (store.getYOffset(entity) <= minJumpHeight) {
+                        store.setFalling(entity, false);
+                        store.setJumping(entity, true);
+                        store.setYOffset(entity, minJumpHeight);
                     }
                 }
 
-                syncY = entity->getYOffset();
+                syncY = store.getYOffset(entity);
             } else {
-                entity->setYOffset(syncY);
+                store.setYOffset(entity, syncY);
             }
         }
     }
+
+    // The jumping entities move at every update
+    if (animating) {
+        dirty = true;
+    }
 }
 
-void Game::renderAll(SDL_Renderer* renderer) const {
+void Game::renderAll(SDL_Renderer* renderer, float alpha) const {
+    const HexagonalGrid& grid = engine.getGrid();
+    const GameEntities& gameEntities = engine.getGameEntities();
+    size_t playerTurn = engine.getPlayerTurn();
+    bool entitySelected = engine.isEntitySelected();
+    int nbplayers = engine.getNbPlayers();
+
+    // Only the part of the grid in the window is drawn
+    GridView view = {cameraX, cameraY, 0, 0};
+    SDL_GetRendererOutputSize(renderer, &view.width, &view.height);
+
     // Draw the grid
-    grid.draw(renderer, cameraX, cameraY);
+    {
+        ScopedTimer timer(ProfilePhase::Grid);
+        renderGame.drawGrid(renderer, grid, view);
+    }
 
-    // Render all entities
-    renderGame.renderEntities(renderer, gameEntities.bandits, "bandit", grid, cameraX, cameraY, textures);
-    renderGame.renderEntities(renderer, gameEntities.banditCamps, "bandit-camp", grid, cameraX, cameraY, textures);
-    renderGame.renderEntities(renderer, gameEntities.treasures, "treasury", grid, cameraX, cameraY, textures);
-    renderGame.renderEntities(renderer, gameEntities.devils, "devil", grid, cameraX, cameraY, textures);
-    renderGame.renderEntities(renderer, gameEntities.forests, "forest", grid, cameraX, cameraY, textures);
+    // Render all entities, the selected entity follows the mouse
+    {
+        ScopedTimer timer(ProfilePhase::Entities);
+        EntityHandle selectedEntity = engine.getSelectedEntity();
+        renderGame.renderEntities(renderer, gameEntities.store, grid, view, icons, selectedEntity, alpha);
+        if (entitySelected) {
+            renderGame.renderSelectedEntity(renderer, selectedEntity, engine.legalMoves(selectedEntity), grid, gameEntities.store, view, icons);
+        }
+    }
 
-    // Render all players' entities
-    renderGame.renderPlayersEntities(renderer, gameEntities.players, playerTurn, grid, cameraX, cameraY, textures, entitySelected, selectedEntityIndex);
+    {
+        ScopedTimer timer(ProfilePhase::Hud);
 
-    // Render the selected entity if any
-    renderGame.renderSelectedEntity(renderer, playerTurn, grid, gameEntities, cameraX, cameraY, textures, entitySelected, selectedEntityIndex);
+        // Display current player's color and information
+        renderGame.renderPlayerInfo(renderer, gameEntities, playerTurn, grid, icons);
 
-    // Display current player's color and information
-    renderGame.renderPlayerInfo(renderer, gameEntities.players, playerTurn, grid, textures);
+        // Render all buttons
+        renderGame.renderAllButtons(renderer, unitButtons, icons, gameEntities, nbplayers, playerTurn, turnButton, undoButton, quitButton, replayButton);
 
-    // Render all buttons
-    renderGame.renderAllButtons(renderer, unitButtons, textures, gameEntities.players, nbplayers, playerTurn, turnButton, undoButton, quitButton, replayButton);
+        // Display game over message if only one player remains
+        if (nbplayers == 1) {
+            renderGame.renderGameOverMessage(renderer, grid, gameEntities.players, unitButtons);
+        }
 
-    // Display game over message if only one player remains
-    if (nbplayers == 1) {
-        renderGame.renderGameOverMessage(renderer, gameEntities.players, unitButtons);
-    }
+        // Render Button Info
+        if(buttonHovered && !entitySelected) {
+            renderGame.RenderButtonInfo(renderer, hoveredButton, icons);
+        }
 
-    // Render Button Info
-    if(buttonHovered && !entitySelected) {
-        renderGame.RenderButtonInfo(renderer, hoveredButton, textures);
+        // The overlay is part of the HUD it measures
+        if (profiler.isEnabled()) {
+            renderGame.renderProfilerOverlay(renderer, profiler);
+        }
     }
 }
@@ -4,49 +4,44 @@
 #include <filesystem>
 #include <SDL2/SDL_image.h>
 
-#include "../players/playermanager.hpp"
+#include "../engine/gameengine.hpp"
 #include "rendergame.hpp"
 
+// SDL frontend of the game: turns the input into actions of the engine and draws its state
 class Game {
 public:
-  Game(double hexSize, const std::vector<std::string>& asciiMap, std::vector<std::string>& entityMap,
+  Game(double hexSize, const std::vector<std::string>& asciiMap, const std::vector<std::string>& entityMap, uint64_t seed,
         int windowWidth, int windowHeight, SDL_Renderer* renderer, int cameraSpeed);
-  ~Game();
 
-  // Copy constructor
-  Game(const Game& other);
-
-  // Assignment operator
-  Game& operator=(const Game& other);
+  // The engine holds the history of the game, a game is not copied
+  Game(const Game& other) = delete;
+  Game& operator=(const Game& other) = delete;
 
   void handleEvent(SDL_Event& event);
+  // Advance the jump animation by UPDATE_STEP seconds
   void update();
-  void renderAll(SDL_Renderer* renderer) const;
+  // Draw the game, alpha (0 to 1) is the fraction of an update elapsed since the last one
+  void renderAll(SDL_Renderer* renderer, float alpha) const;
+
+  static constexpr double UPDATE_STEP = 1.0 / 240; // Seconds simulated by an update, the jump animation is tuned for it
 
   bool getEndGame() const { return endGame; }
   void setEndGame(bool endGame) { this->endGame = endGame; }
 
-  bool getUndo() const { return undo; }
-  void setUndo(bool undo) { this->undo = undo; }
-
-  bool getTurnButtonClicked() const { return turnButtonClicked; }
-  void setTurnButtonClicked(bool clicked) { turnButtonClicked = clicked; }
-
-  bool getReplayButtonClicked() const { return replayButtonClicked; }
-  void setReplayButtonClicked(bool clicked) { replayButtonClicked = clicked; }
+  // The frame changed since it was last drawn (an action, a camera move, a hovered button...), or entities are jumping
+  bool needsRedraw() const { return dirty; }
+  bool isAnimating() const { return animating; }
+  void markDrawn() { dirty = false; }
 
 private:
-  HexagonalGrid grid;
-  EntityManager entityManager;
+  // Go back to the start of the turn (or of the previous turn), forward to the turn undone, or to the start of the game
+  void undoTurn();
+  void redoTurn();
+  void restart();
+
+  GameEngine engine;
   RenderGame renderGame;
-  PlayerManager playerManager;
-  GameEntities gameEntities;
-  size_t playerTurn;
-  bool entitySelected;
-  std::vector<SDL_Texture*> textures;
-  int selectedEntityIndex;
-  int nbplayers;
-  int turn;
+  IconAtlas icons;
   std::vector<Button> unitButtons;
   Button turnButton;
   Button undoButton;
@@ -55,12 +50,11 @@ private:
   Button* draggedButton;
   int cameraX, cameraY, cameraSpeed;
   bool endGame;
-  bool undo;
-  bool turnButtonClicked;
-  bool replayButtonClicked;
   bool buttonHovered;
   Button hoveredButton;
   int defaultHexSize;
+  bool dirty;       // The frame must be drawn again
+  bool animating;   // Entities of the current player were jumping at the last update
 };
 
 #endif // GAME_HPP
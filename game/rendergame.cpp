@@ -1,18 +1,23 @@
 #include "rendergame.hpp"
 
-SDL_Rect RenderGame::entityToRect(const Entity& entity, const HexagonalGrid& grid, int cameraX, int cameraY) const {
-    int x = static_cast<int>(grid.hexToPixel(entity.getHex()).x - grid.getHexSize() / 2) - cameraX;
-    int y = static_cast<int>(grid.hexToPixel(entity.getHex()).y - grid.getHexSize() / 2 - entity.getYOffset()) - cameraY;
+void RenderGame::drawGrid(SDL_Renderer* renderer, const HexagonalGrid& grid, const GridView& view) const {
+    terrainRenderer.draw(renderer, grid, view);
+}
+
+SDL_Rect RenderGame::entityToRect(const EntityStore& store, EntityHandle entity, const HexagonalGrid& grid, const GridView& view, float alpha) const {
+    Point center = grid.hexToPixel(store.getHex(entity));
+    int x = static_cast<int>(center.x - grid.getHexSize() / 2) - view.x;
+    int y = static_cast<int>(center.y - grid.getHexSize() / 2 - store.getYOffset(entity, alpha)) - view.y;
     int w_h = static_cast<int>(grid.getHexSize());
     return {x, y, w_h, w_h};
 }
 
-void RenderGame::render_entity(SDL_Renderer* renderer, const Entity& entity, SDL_Texture* texture, const HexagonalGrid& grid, int cameraX, int cameraY) const {
-    SDL_Rect entityRect = entityToRect(entity, grid, cameraX, cameraY);
-    SDL_RenderCopy(renderer, texture, NULL, &entityRect);
+void RenderGame::render_entity(SDL_Renderer* renderer, const EntityStore& store, EntityHandle entity, const IconAtlas& icons, const HexagonalGrid& grid, const GridView& view, float alpha) const {
+    SDL_Rect entityRect = entityToRect(store, entity, grid, view, alpha);
+    icons.draw(renderer, store.getIcon(entity), entityRect);
 }
 
-void RenderGame::renderButton(SDL_Renderer* renderer, const Button& button, const std::vector<SDL_Texture*>& textures) const {
+void RenderGame::renderButton(SDL_Renderer* renderer, const Button& button, const IconAtlas& icons) const {
     SDL_Rect buttonRect = button.getRect();
 
     // Draw button background
@@ -24,24 +29,21 @@ void RenderGame::renderButton(SDL_Renderer* renderer, const Button& button, cons
     SDL_RenderDrawRect(renderer, &buttonRect);
     
     // Draw button icon
-    SDL_Texture* iconTexture = textures[getIconIndex(button.getIconName())];
-    SDL_RenderCopy(renderer, iconTexture, NULL, &buttonRect);
+    icons.draw(renderer, button.getIcon(), buttonRect);
 
     // Draw cost text with better visibility
     renderButtonText(renderer, button, buttonRect);
 }
 
-void RenderGame::renderButtonNoBorder(SDL_Renderer* renderer, const Button& button, const std::vector<SDL_Texture*>& textures) const {
+void RenderGame::renderButtonNoBorder(SDL_Renderer* renderer, const Button& button, const IconAtlas& icons) const {
     SDL_Rect buttonRect = button.getRect();
 
     // Draw button icon
-    SDL_Texture* iconTexture = textures[getIconIndex(button.getIconName())];
-    SDL_RenderCopy(renderer, iconTexture, NULL, &buttonRect);
+    icons.draw(renderer, button.getIcon(), buttonRect);
 }
 
 void RenderGame::renderButtonText(SDL_Renderer* renderer, const Button& button, SDL_Rect& buttonRect) const {
-    TTF_Font* font = TTF_OpenFont("assets/OpenSans.ttf", 16); // Larger font size
-    if (font) {
+    if (textCache.getFont(16)) { // Larger font size
         // Create a small background for the text
         SDL_Rect textBgRect = {
             buttonRect.x,
@@ -56,137 +58,104 @@ void RenderGame::renderButtonText(SDL_Renderer* renderer, const Button& button,
 
         SDL_Color textColor = {255, 255, 0, 255};
 
-        std::string costText = std::to_string(button.getCost());
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, costText.c_str(), textColor);
-
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-            if (textTexture) {
-                // Center the text in the background
-                int textWidth = textSurface->w;
-                int textHeight = textSurface->h;
-
-                SDL_Rect costRect = {
-                    buttonRect.x + (buttonRect.w - textWidth) / 2,
-                    buttonRect.y + buttonRect.h - textHeight - 2,
-                    textWidth,
-                    textHeight
-                };
-
-                SDL_RenderCopy(renderer, textTexture, NULL, &costRect);
-                SDL_DestroyTexture(textTexture);
-            }
-
-            SDL_FreeSurface(textSurface);
+        int textWidth, textHeight;
+        SDL_Texture* textTexture = textCache.getText(renderer, 16, textColor, std::to_string(button.getCost()), textWidth, textHeight);
+        if (textTexture) {
+            // Center the text in the background
+            SDL_Rect costRect = {
+                buttonRect.x + (buttonRect.w - textWidth) / 2,
+                buttonRect.y + buttonRect.h - textHeight - 2,
+                textWidth,
+                textHeight
+            };
+
+            SDL_RenderCopy(renderer, textTexture, NULL, &costRect);
         }
-
-        TTF_CloseFont(font);
     }
 }
 
-void RenderGame::renderTurnButton(SDL_Renderer* renderer, const Button& turnButton, const std::vector<SDL_Texture*>& textures, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn) const {
+void RenderGame::renderTurnButton(SDL_Renderer* renderer, const Button& turnButton, const IconAtlas& icons, const GameEntities& gameEntities, size_t playerTurn) const {
     SDL_Rect buttonRect = turnButton.getRect();
-    auto& currentPlayer = players[playerTurn];
+    auto& currentPlayer = gameEntities.players[playerTurn];
 
-    // Determine the correct texture for the turn button
-    SDL_Texture* iconTexture = determineTurnButtonTexture(textures, turnButton, currentPlayer);
+    // Determine the correct icon for the turn button
+    Icon icon = determineTurnButtonIcon(turnButton, gameEntities.store, currentPlayer);
 
     // Draw button icon
-    SDL_RenderCopy(renderer, iconTexture, NULL, &buttonRect);
+    icons.draw(renderer, icon, buttonRect);
 }
 
-SDL_Texture* RenderGame::determineTurnButtonTexture(const std::vector<SDL_Texture*>& textures, const Button& turnButton, const std::shared_ptr<Player>& currentPlayer) const {
-    SDL_Texture* iconTexture = textures[getIconIndex(turnButton.getIconName())];
-    bool allEntitiesMoved = std::all_of(currentPlayer->getEntities().begin(), currentPlayer->getEntities().end(), [](const auto& entity) {
-        return entity->hasMoved();
+Icon RenderGame::determineTurnButtonIcon(const Button& turnButton, const EntityStore& store, const std::shared_ptr<Player>& currentPlayer) const {
+    Icon icon = turnButton.getIcon();
+    bool allEntitiesMoved = std::all_of(currentPlayer->getEntities().begin(), currentPlayer->getEntities().end(), [&](EntityHandle entity) {
+        return store.hasMoved(entity);
     });
 
     if (allEntitiesMoved && currentPlayer->getCoins() < 10) {
-        iconTexture = textures[getIconIndex("nextbright")];
+        icon = Icon::NextBright;
     }
-    return iconTexture;
+    return icon;
 }
 
-template <typename T>
-void RenderGame::renderEntities(SDL_Renderer* renderer, const std::vector<std::shared_ptr<T>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const {
-    for (const auto& entity : entities) {
-        render_entity(renderer, *entity, textures[getIconIndex(textureKey)], grid, cameraX, cameraY);
-    }
+void RenderGame::renderEntities(SDL_Renderer* renderer, const EntityStore& store, const HexagonalGrid& grid, const GridView& view, const IconAtlas& icons, EntityHandle selectedEntity, float alpha) const {
+    // Entities are found through the occupants of the hexes in view, their icons don't overlap so any order will do
+    grid.forEachCellInView(view, [&](int index) {
+        const HexOccupant& occupant = grid.getCellOccupant(index);
+        if (occupant.kind != EntityKind::None && occupant.entity != selectedEntity) {
+            render_entity(renderer, store, occupant.entity, icons, grid, view, alpha);
+        }
+    });
 }
 
-// Explicit template instantiation
-template void RenderGame::renderEntities<Bandit>(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Bandit>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
-template void RenderGame::renderEntities<BanditCamp>(SDL_Renderer* renderer, const std::vector<std::shared_ptr<BanditCamp>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
-template void RenderGame::renderEntities<Treasure>(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Treasure>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
-template void RenderGame::renderEntities<Devil>(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Devil>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
-template void RenderGame::renderEntities<Forest>(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Forest>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
+void RenderGame::renderSelectedEntity(SDL_Renderer* renderer, EntityHandle selectedEntity, const std::vector<Hex>& legalMoves, const HexagonalGrid& grid, const EntityStore& store, const GridView& view, const IconAtlas& icons) const {
+    SDL_Rect entityRect = entityToRect(store, selectedEntity, grid, view, 1.0f);
+    int mouseX, mouseY;
+    SDL_GetMouseState(&mouseX, &mouseY);
+    entityRect.x = mouseX - entityRect.w / 2;
+    entityRect.y = mouseY - entityRect.h / 2;
+    icons.draw(renderer, store.getIcon(selectedEntity), entityRect);
 
-void RenderGame::renderPlayersEntities(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures, bool entitySelected, int selectedEntityIndex) const {
-    auto& currentPlayer = players[playerTurn];
+    highlightAccessibleHexes(renderer, selectedEntity, legalMoves, grid, store, view, icons);
+}
 
-    for (size_t i = 0; i < players.size(); i++) {
-        const auto& player = players[i];
-        for (const auto& entity : player->getEntities()) {
-            if (entitySelected && entity == currentPlayer->getEntities()[selectedEntityIndex]) {
+void RenderGame::highlightAccessibleHexes(SDL_Renderer* renderer, EntityHandle selectedEntity, const std::vector<Hex>& legalMoves, const HexagonalGrid& grid, const EntityStore& store, const GridView& view, const IconAtlas& icons) const {
+    if (store.getKind(selectedEntity) != EntityKind::Castle) {
+        OwnerId owner = store.getOwner(selectedEntity);
+        for (const auto& hex : legalMoves) {
+            if (!grid.isInView(hex, view)) {
                 continue;
             }
-            render_entity(renderer, *entity, textures[getIconIndex(entity->getName())], grid, cameraX, cameraY);
-        }
-    }
-}
-
-void RenderGame::renderSelectedEntity(SDL_Renderer* renderer, size_t playerTurn, const HexagonalGrid& grid, const GameEntities& gameEntities, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures, bool entitySelected, int selectedEntityIndex) const {
-    if (entitySelected) {
-        const auto& playerEntities = gameEntities.players[playerTurn]->getEntities();
-        const std::shared_ptr<Entity>& selectedEntityptr = playerEntities[selectedEntityIndex];
-        const Entity& selectedEntity = *playerEntities[selectedEntityIndex];
-        SDL_Rect entityRect = entityToRect(selectedEntity, grid, cameraX, cameraY);
-        int mouseX, mouseY;
-        SDL_GetMouseState(&mouseX, &mouseY);
-        entityRect.x = mouseX - entityRect.w / 2;
-        entityRect.y = mouseY - entityRect.h / 2;
-        SDL_RenderCopy(renderer, textures[getIconIndex(selectedEntity.getName())], NULL, &entityRect);
-
-        highlightAccessibleHexes(renderer, selectedEntityptr, grid, cameraX, cameraY, playerTurn, gameEntities, textures);
-    }
-}
-
-void RenderGame::highlightAccessibleHexes(SDL_Renderer* renderer, const std::shared_ptr<Entity>& selectedEntity, const HexagonalGrid& grid, int cameraX, int cameraY, size_t playerTurn, const GameEntities& gameEntities, const std::vector<SDL_Texture*>& textures) const {
-    if (selectedEntity->getName() != "castle") {
-        for (const auto& hex : grid.getHexes()) {
-            bool banditOnHex = std::any_of(gameEntities.bandits.begin(), gameEntities.bandits.end(), [&](const auto& bandit) {
-                return bandit->getHex() == hex;
-            });
-            if (entityManager.HexNotOnTerritoryAndAccessible(selectedEntity, hex, grid, playerTurn, gameEntities) || (grid.getHexColors().at(hex) == gameEntities.players[playerTurn]->getColor() && banditOnHex)) {
-                drawHexHighlight(renderer, hex, grid, cameraX, cameraY, gameEntities, textures);
+            // Moves inside the territory are not highlighted, unless they chase a bandit
+            if (!grid.isOwnedBy(hex, owner) || grid.getOccupant(hex).kind == EntityKind::Bandit) {
+                drawHexHighlight(renderer, hex, grid, view, icons);
             }
         }
     }
 }
 
-void RenderGame::drawHexHighlight(SDL_Renderer* renderer, const Hex& hex, const HexagonalGrid& grid, int cameraX, int cameraY, const GameEntities& gameEntities, const std::vector<SDL_Texture*>& textures) const {
+void RenderGame::drawHexHighlight(SDL_Renderer* renderer, const Hex& hex, const HexagonalGrid& grid, const GridView& view, const IconAtlas& icons) const {
     Point hexPos = grid.hexToPixel(hex);
     SDL_Rect hexRect;
-    hexRect.x = static_cast<int>(hexPos.x - grid.getHexSize() / 2) - cameraX;
-    hexRect.y = static_cast<int>(hexPos.y - grid.getHexSize() / 2) - cameraY;
+    hexRect.x = static_cast<int>(hexPos.x - grid.getHexSize() / 2) - view.x;
+    hexRect.y = static_cast<int>(hexPos.y - grid.getHexSize() / 2) - view.y;
     hexRect.w = static_cast<int>(grid.getHexSize());
     hexRect.h = static_cast<int>(grid.getHexSize());
 
-    if (entityManager.entityOnHex(hex, gameEntities)) {
+    if (entityManager.entityOnHex(hex, grid)) {
         SDL_SetRenderDrawColor(renderer, 150, 0, 0, 100); // Red color
         SDL_RenderDrawRect(renderer, &hexRect);
         SDL_Rect swordRect = {hexRect.x + hexRect.w / 2 - 10, hexRect.y + hexRect.h / 2 - 10, 20, 20};
-        SDL_RenderCopy(renderer, textures[getIconIndex("swords")], NULL, &swordRect);
+        icons.draw(renderer, Icon::Swords, swordRect);
     } else {
         SDL_SetRenderDrawColor(renderer, 150, 150, 0, 100); // Yellow color
         SDL_RenderDrawRect(renderer, &hexRect);
     }
 }
 
-void RenderGame::renderPlayerInfo(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const HexagonalGrid& grid, const std::vector<SDL_Texture*>& textures) const {
+void RenderGame::renderPlayerInfo(SDL_Renderer* renderer, const GameEntities& gameEntities, size_t playerTurn, const HexagonalGrid& grid, const IconAtlas& icons) const {
+    const auto& players = gameEntities.players;
     if (playerTurn < players.size()) {
-        SDL_Color currentColor = players[playerTurn]->getColor();
+        Color currentColor = grid.getOwnerColor(players[playerTurn]->getOwner());
         SDL_Rect colorRect = {10, 10, 50, 30};
         SDL_SetRenderDrawColor(renderer, currentColor.r, currentColor.g, currentColor.b, currentColor.a);
         SDL_RenderFillRect(renderer, &colorRect);
@@ -194,55 +163,53 @@ void RenderGame::renderPlayerInfo(SDL_Renderer* renderer, const std::vector<std:
         SDL_RenderDrawRect(renderer, &colorRect);
     }
 
-    renderPlayerResources(renderer, grid, players, playerTurn, textures);
+    renderPlayerResources(renderer, grid, gameEntities, playerTurn, icons);
 }
 
-void RenderGame::renderPlayerResources(SDL_Renderer* renderer, const HexagonalGrid& grid, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const std::vector<SDL_Texture*>& textures) const {
-    TTF_Font* font = TTF_OpenFont("assets/OpenSans.ttf", 24);
-    RenderData renderData(renderer, font, textures);
+void RenderGame::renderPlayerResources(SDL_Renderer* renderer, const HexagonalGrid& grid, const GameEntities& gameEntities, size_t playerTurn, const IconAtlas& icons) const {
+    const auto& players = gameEntities.players;
+    RenderData renderData(renderer, textCache, 24, icons);
 
     std::string coinsnumber = std::to_string(players[playerTurn]->getCoins());
     SDL_Rect coinRect = {10, 60, 50, 30};
     if (players[playerTurn]->getCoins() < 50) {
-        renderData.renderImageWithText(coinRect, "coin", coinsnumber);
+        renderData.renderImageWithText(coinRect, Icon::Coin, coinsnumber);
     } else {
-        renderData.renderImageWithText(coinRect, "coins", coinsnumber);
+        renderData.renderImageWithText(coinRect, Icon::Coins, coinsnumber);
     }
 
-    int totalupkeep = grid.getNbCasesColor(players[playerTurn]->getColor());
-    for (const auto& entity : players[playerTurn]->getEntities()) {
-        totalupkeep -= entity->getUpkeep();
+    int totalupkeep = grid.getNbCasesOwnedBy(players[playerTurn]->getOwner());
+    for (EntityHandle entity : players[playerTurn]->getEntities()) {
+        totalupkeep -= gameEntities.store.getUpkeep(entity);
     }
     std::string stringupkeep = std::to_string(totalupkeep);
     SDL_Rect upkeepRect = {10, 100, 50, 60};
     if (totalupkeep < 0) {
-        renderData.renderImageWithText(upkeepRect, "deficit", stringupkeep);
+        renderData.renderImageWithText(upkeepRect, Icon::Deficit, stringupkeep);
     } else {
-        renderData.renderImageWithText(upkeepRect, "surplus", stringupkeep);
+        renderData.renderImageWithText(upkeepRect, Icon::Surplus, stringupkeep);
     }
-
-    TTF_CloseFont(font);
 }
 
-void RenderGame::renderAllButtons(SDL_Renderer* renderer, const std::vector<Button>& unitButtons, const std::vector<SDL_Texture*>& textures, const std::vector<std::shared_ptr<Player>>& players, const int&nbplayers, size_t playerTurn, const Button& turnButton, const Button& undoButton, const Button& quitButton, const Button& replayButton) const {
+void RenderGame::renderAllButtons(SDL_Renderer* renderer, const std::vector<Button>& unitButtons, const IconAtlas& icons, const GameEntities& gameEntities, const int&nbplayers, size_t playerTurn, const Button& turnButton, const Button& undoButton, const Button& quitButton, const Button& replayButton) const {
     for (const auto& button : unitButtons) {
-        renderButton(renderer, button, textures);
+        renderButton(renderer, button, icons);
     }
 
     // Render the undo and quit buttons
-    renderButtonNoBorder(renderer, undoButton, textures);
-    renderButtonNoBorder(renderer, quitButton, textures);
+    renderButtonNoBorder(renderer, undoButton, icons);
+    renderButtonNoBorder(renderer, quitButton, icons);
 
     // Render the replay button
     if (nbplayers == 1) {
-        renderButtonNoBorder(renderer, replayButton, textures);
+        renderButtonNoBorder(renderer, replayButton, icons);
     } else {
         // Render the turn button
-        renderTurnButton(renderer, turnButton, textures, players, playerTurn);
+        renderTurnButton(renderer, turnButton, icons, gameEntities, playerTurn);
     }
 }
 
-void RenderGame::RenderButtonInfo(SDL_Renderer* renderer, Button button, const std::vector<SDL_Texture*>& textures) const {
+void RenderGame::RenderButtonInfo(SDL_Renderer* renderer, Button button, const IconAtlas& icons) const {
     SDL_Rect buttonRect = button.getRect();
     int buttonSpacing = 10;
     int ratioInfoW = 27;
@@ -257,22 +224,19 @@ void RenderGame::RenderButtonInfo(SDL_Renderer* renderer, Button button, const s
 
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderDrawRect(renderer, &infoRect);
-    std::string iconName = button.getIconName();
-    if (iconName == "villager") {
-        iconName = "info-villager";
-    } else if (iconName == "pikeman") {
-        iconName = "info-pikeman";
-    } else if (iconName == "knight") {
-        iconName = "info-knight";
-    } else if (iconName == "hero") {
-        iconName = "info-hero";
-    } else if (iconName == "castle") {
-        iconName = "info-castle";
+    Icon icon = button.getIcon();
+    switch (icon) {
+        case Icon::Villager: icon = Icon::InfoVillager; break;
+        case Icon::Pikeman: icon = Icon::InfoPikeman; break;
+        case Icon::Knight: icon = Icon::InfoKnight; break;
+        case Icon::Hero: icon = Icon::InfoHero; break;
+        case Icon::Castle: icon = Icon::InfoCastle; break;
+        default: break;
     }
-    SDL_RenderCopy(renderer, textures[getIconIndex(iconName)], NULL, &infoRect);
+    icons.draw(renderer, icon, infoRect);
 }
 
-void RenderGame::renderGameOverMessage(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, const std::vector<Button>& unitButtons) const {
+void RenderGame::renderGameOverMessage(SDL_Renderer* renderer, const HexagonalGrid& grid, const std::vector<std::shared_ptr<Player>>& players, const std::vector<Button>& unitButtons) const {
     int windowWidth, windowHeight;
     SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
 
@@ -285,46 +249,69 @@ void RenderGame::renderGameOverMessage(SDL_Renderer* renderer, const std::vector
     SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255);
     SDL_RenderDrawRect(renderer, &messageBgRect);
 
-    TTF_Font* font = TTF_OpenFont("assets/OpenSans.ttf", 24);
-    if (font) {
-        SDL_Color textColor = {255, 255, 255, 255};
-        std::string gameOverText = "Game over! Player";
-
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, gameOverText.c_str(), textColor);
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            if (textTexture) {
-                SDL_Rect textRect = {messageBgRect.x + 20, messageBgRect.y + (messageBgRect.h - textSurface->h) / 2, textSurface->w, textSurface->h};
-                SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-
-                SDL_Rect winnerColorRect = {textRect.x + textRect.w + 10, textRect.y + (textRect.h - 30) / 2, 30, 30};
-                SDL_Color winnerColor;
-                for (auto& player : players) {
-                    if (player->isAlive()) {
-                        winnerColor = player->getColor();
-                        break;
-                    }
-                }
-                SDL_SetRenderDrawColor(renderer, winnerColor.r, winnerColor.g, winnerColor.b, winnerColor.a);
-                SDL_RenderFillRect(renderer, &winnerColorRect);
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                SDL_RenderDrawRect(renderer, &winnerColorRect);
-
-                std::string hasWonText = "has won!";
-                SDL_Surface* wonSurface = TTF_RenderText_Solid(font, hasWonText.c_str(), textColor);
-                if (wonSurface) {
-                    SDL_Texture* wonTexture = SDL_CreateTextureFromSurface(renderer, wonSurface);
-                    if (wonTexture) {
-                        SDL_Rect wonRect = {winnerColorRect.x + winnerColorRect.w + 10, textRect.y, wonSurface->w, wonSurface->h};
-                        SDL_RenderCopy(renderer, wonTexture, NULL, &wonRect);
-                        SDL_DestroyTexture(wonTexture);
-                    }
-                    SDL_FreeSurface(wonSurface);
-                }
-                SDL_DestroyTexture(textTexture);
+    SDL_Color textColor = {255, 255, 255, 255};
+    int textWidth, textHeight;
+    SDL_Texture* textTexture = textCache.getText(renderer, 24, textColor, "Game over! Player", textWidth, textHeight);
+    if (textTexture) {
+        SDL_Rect textRect = {messageBgRect.x + 20, messageBgRect.y + (messageBgRect.h - textHeight) / 2, textWidth, textHeight};
+        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
+
+        SDL_Rect winnerColorRect = {textRect.x + textRect.w + 10, textRect.y + (textRect.h - 30) / 2, 30, 30};
+        Color winnerColor = defaultColor;
+        for (auto& player : players) {
+            if (player->isAlive()) {
+                winnerColor = grid.getOwnerColor(player->getOwner());
+                break;
             }
-            SDL_FreeSurface(textSurface);
         }
-        TTF_CloseFont(font);
+        SDL_SetRenderDrawColor(renderer, winnerColor.r, winnerColor.g, winnerColor.b, winnerColor.a);
+        SDL_RenderFillRect(renderer, &winnerColorRect);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderDrawRect(renderer, &winnerColorRect);
+
+        int wonWidth, wonHeight;
+        SDL_Texture* wonTexture = textCache.getText(renderer, 24, textColor, "has won!", wonWidth, wonHeight);
+        if (wonTexture) {
+            SDL_Rect wonRect = {winnerColorRect.x + winnerColorRect.w + 10, textRect.y, wonWidth, wonHeight};
+            SDL_RenderCopy(renderer, wonTexture, NULL, &wonRect);
+        }
+    }
+}
+
+void RenderGame::renderProfilerOverlay(SDL_Renderer* renderer, const Profiler& profiler) const {
+    int windowWidth, windowHeight;
+    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+
+    const int fontSize = 16;
+    const int lineHeight = 22;
+    SDL_Rect overlayRect = {windowWidth - 400 - 10, 10, 400, 20 + (NB_PROFILE_PHASES + 1) * lineHeight};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+    SDL_RenderFillRect(renderer, &overlayRect);
+
+    // One line per phase: minimum, average and 99th percentile of its last samples. The lines are made again a few
+    // times per second, in between the same strings are drawn and their textures come from the cache.
+    Uint32 now = SDL_GetTicks();
+    if (profilerLines.empty() || now - profilerLinesTime >= PROFILER_REFRESH_MS) {
+        profilerLinesTime = now;
+        profilerLines.clear();
+        profilerLines.push_back("Profiler (F3), last " + std::to_string(profiler.getStats(ProfilePhase::Frame).count) + " frames, ms");
+        for (int i = 0; i < NB_PROFILE_PHASES; ++i) {
+            Profiler::Stats stats = profiler.getStats(static_cast<ProfilePhase>(i));
+            char line[128];
+            std::snprintf(line, sizeof(line), "%s: min %.2f  avg %.2f  p99 %.2f", profilePhaseNames[i], stats.min, stats.avg, stats.p99);
+            profilerLines.push_back(line);
+        }
     }
-}
\ No newline at end of file
+
+    SDL_Color textColor = {255, 255, 255, 255};
+    int y = overlayRect.y + 10;
+    for (const std::string& line : profilerLines) {
+        int textWidth, textHeight;
+        SDL_Texture* textTexture = textCache.getText(renderer, fontSize, textColor, line, textWidth, textHeight);
+        if (textTexture) {
+            SDL_Rect textRect = {overlayRect.x + 10, y, textWidth, textHeight};
+            SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
+        }
+        y += lineHeight;
+    }
+}
@@ -1,36 +1,50 @@
 #ifndef RENDERGAME_HPP
 #define RENDERGAME_HPP
 
+#include "../core/profiler.hpp"
 #include "../entities/entitymanager.hpp"
 #include "../ui/button.hpp"
 #include "../ui/data.hpp"
+#include "terrainrenderer.hpp"
+#include <cmath>
+#include <cstdio>
 
 class RenderGame {
 public:
-    template <typename T>
-    void renderEntities(SDL_Renderer* renderer, const std::vector<std::shared_ptr<T>>& entities, const std::string& textureKey, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures) const;
-    void renderPlayersEntities(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const HexagonalGrid& grid, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures, bool entitySelected, int selectedEntityIndex) const;
-    void renderSelectedEntity(SDL_Renderer* renderer, size_t playerTurn, const HexagonalGrid& grid, const GameEntities& gameEntities, int cameraX, int cameraY, const std::vector<SDL_Texture*>& textures, bool entitySelected, int selectedEntityIndex) const;
-    void renderPlayerInfo(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const HexagonalGrid& grid, const std::vector<SDL_Texture*>& textures) const;
-    void renderAllButtons(SDL_Renderer* renderer, const std::vector<Button>& unitButtons, const std::vector<SDL_Texture*>& textures, const std::vector<std::shared_ptr<Player>>& players, const int& nbplayers, size_t playerTurn, const Button& turnButton, const Button& undoButton, const Button& quitButton, const Button& replayButton) const;
-    void renderTurnButton(SDL_Renderer* renderer, const Button& turnButton, const std::vector<SDL_Texture*>& textures, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn) const;
-    void RenderButtonInfo(SDL_Renderer* renderer, Button button, const std::vector<SDL_Texture*>& textures) const;
-    void renderGameOverMessage(SDL_Renderer* renderer, const std::vector<std::shared_ptr<Player>>& players, const std::vector<Button>& unitButtons) const;
+    void drawGrid(SDL_Renderer* renderer, const HexagonalGrid& grid, const GridView& view) const;
+    void invalidateTerrain() { terrainRenderer.invalidate(); } // The renderer lost the content of its render targets
+    // Render the entities standing on the hexes in view, but the selected entity (drawn under the mouse)
+    // alpha is the fraction of an update elapsed since the last one, the jumping entities are drawn in between
+    void renderEntities(SDL_Renderer* renderer, const EntityStore& store, const HexagonalGrid& grid, const GridView& view, const IconAtlas& icons, EntityHandle selectedEntity, float alpha) const;
+    void renderSelectedEntity(SDL_Renderer* renderer, EntityHandle selectedEntity, const std::vector<Hex>& legalMoves, const HexagonalGrid& grid, const EntityStore& store, const GridView& view, const IconAtlas& icons) const;
+    void renderPlayerInfo(SDL_Renderer* renderer, const GameEntities& gameEntities, size_t playerTurn, const HexagonalGrid& grid, const IconAtlas& icons) const;
+    void renderAllButtons(SDL_Renderer* renderer, const std::vector<Button>& unitButtons, const IconAtlas& icons, const GameEntities& gameEntities, const int& nbplayers, size_t playerTurn, const Button& turnButton, const Button& undoButton, const Button& quitButton, const Button& replayButton) const;
+    void renderTurnButton(SDL_Renderer* renderer, const Button& turnButton, const IconAtlas& icons, const GameEntities& gameEntities, size_t playerTurn) const;
+    void RenderButtonInfo(SDL_Renderer* renderer, Button button, const IconAtlas& icons) const;
+    void renderGameOverMessage(SDL_Renderer* renderer, const HexagonalGrid& grid, const std::vector<std::shared_ptr<Player>>& players, const std::vector<Button>& unitButtons) const;
+    // Render the statistics of each phase measured by the profiler in the top right corner, updated a few times per second
+    void renderProfilerOverlay(SDL_Renderer* renderer, const Profiler& profiler) const;
 
 private:
-    SDL_Rect entityToRect(const Entity& entity, const HexagonalGrid& grid, int cameraX, int cameraY) const;
-    void render_entity(SDL_Renderer* renderer, const Entity& entity, SDL_Texture* texture, const HexagonalGrid& grid, int cameraX, int cameraY) const;
-    void renderButton(SDL_Renderer* renderer, const Button& button, const std::vector<SDL_Texture*>& textures) const;
-    void renderButtonNoBorder(SDL_Renderer* renderer, const Button& button, const std::vector<SDL_Texture*>& textures) const;
+    SDL_Rect entityToRect(const EntityStore& store, EntityHandle entity, const HexagonalGrid& grid, const GridView& view, float alpha) const;
+    void render_entity(SDL_Renderer* renderer, const EntityStore& store, EntityHandle entity, const IconAtlas& icons, const HexagonalGrid& grid, const GridView& view, float alpha) const;
+    void renderButton(SDL_Renderer* renderer, const Button& button, const IconAtlas& icons) const;
+    void renderButtonNoBorder(SDL_Renderer* renderer, const Button& button, const IconAtlas& icons) const;
     void renderButtonText(SDL_Renderer* renderer, const Button& button, SDL_Rect& buttonRect) const;
-    SDL_Texture* determineTurnButtonTexture(const std::vector<SDL_Texture*>& textures, const Button& turnButton, const std::shared_ptr<Player>& currentPlayer) const;
+    Icon determineTurnButtonIcon(const Button& turnButton, const EntityStore& store, const std::shared_ptr<Player>& currentPlayer) const;
 
-    void highlightAccessibleHexes(SDL_Renderer* renderer, const std::shared_ptr<Entity>& selectedEntity, const HexagonalGrid& grid, int cameraX, int cameraY, size_t playerTurn, const GameEntities& GameEntities, const std::vector<SDL_Texture*>& textures) const;
-    void drawHexHighlight(SDL_Renderer* renderer, const Hex& hex, const HexagonalGrid& grid, int cameraX, int cameraY, const GameEntities& gameEntities, const std::vector<SDL_Texture*>& textures) const;
+    void highlightAccessibleHexes(SDL_Renderer* renderer, EntityHandle selectedEntity, const std::vector<Hex>& legalMoves, const HexagonalGrid& grid, const EntityStore& store, const GridView& view, const IconAtlas& icons) const;
+    void drawHexHighlight(SDL_Renderer* renderer, const Hex& hex, const HexagonalGrid& grid, const GridView& view, const IconAtlas& icons) const;
 
-    void renderPlayerResources(SDL_Renderer* renderer, const HexagonalGrid& grid, const std::vector<std::shared_ptr<Player>>& players, size_t playerTurn, const std::vector<SDL_Texture*>& textures) const;
+    void renderPlayerResources(SDL_Renderer* renderer, const HexagonalGrid& grid, const GameEntities& gameEntities, size_t playerTurn, const IconAtlas& icons) const;
     
     EntityManager entityManager;
+    mutable TerrainRenderer terrainRenderer; // Buffers of the grid kept from a frame to the next
+    mutable TextCache textCache;             // Fonts and texts of the HUD kept from a frame to the next
+
+    static const Uint32 PROFILER_REFRESH_MS = 250;      // Period of the update of the profiler overlay
+    mutable std::vector<std::string> profilerLines;     // Lines of the profiler overlay, made at most every PROFILER_REFRESH_MS
+    mutable Uint32 profilerLinesTime = 0;               // SDL_GetTicks() when the lines were made
 };
 
 #endif // RENDERGAME_HPP
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "terrainrenderer.hpp"
+#include <iostream>
+
+// Vertices and triangles of a hex: a fan around the center for the fill, a ring of quads for the outline
+static const int FILL_VERTICES = 7;
+static const int FILL_INDICES = 6 * 3;
+static const int OUTLINE_VERTICES = 12;
+static const int OUTLINE_INDICES = 6 * 6;
+
+static const SDL_Color outlineColor = {0, 0, 0, 255};
+
+TerrainRenderer::~TerrainRenderer() {
+    if (layer) {
+        SDL_DestroyTexture(layer);
+    }
+}
+
+void TerrainRenderer::updateCorners(double hexSize) {
+    if (hexSize == cornersHexSize) {
+        return;
+    }
+    cornersHexSize = hexSize;
+    for (int i = 0; i < 6; ++i) {
+        double angle = 2 * M_PI / 6 * (i + 0.5); // Pointy-top hex
+        float cosAngle = static_cast<float>(std::cos(angle));
+        float sinAngle = static_cast<float>(std::sin(angle));
+        float size = static_cast<float>(hexSize);
+        fillCorners[i] = {size * cosAngle, size * sinAngle};
+        outlineOuterCorners[i] = {(size + 0.5f) * cosAngle, (size + 0.5f) * sinAngle};
+        outlineInnerCorners[i] = {(size - 0.5f) * cosAngle, (size - 0.5f) * sinAngle};
+    }
+}
+
+void TerrainRenderer::updateIndices(size_t nbHexes) {
+    // The triangles of a hex only refer to its own vertices, the indices of more hexes also fit fewer hexes
+    if (nbHexes <= indicesNbHexes) {
+        return;
+    }
+    fillIndices.reserve(nbHexes * FILL_INDICES);
+    outlineIndices.reserve(nbHexes * OUTLINE_INDICES);
+    for (size_t h = indicesNbHexes; h < nbHexes; ++h) {
+        int fill = static_cast<int>(h) * FILL_VERTICES;
+        int outline = static_cast<int>(h) * OUTLINE_VERTICES;
+        for (int i = 0; i < 6; ++i) {
+            int next = (i + 1) % 6;
+            fillIndices.insert(fillIndices.end(), {fill, fill + 1 + i, fill + 1 + next});
+            outlineIndices.insert(outlineIndices.end(), {
+                outline + i, outline + next, outline + 6 + i,
+                outline + next, outline + 6 + next, outline + 6 + i
+            });
+        }
+    }
+    indicesNbHexes = nbHexes;
+}
+
+void TerrainRenderer::addHex(float x, float y, const Color& color) {
+    SDL_Color fillColor = {color.r, color.g, color.b, color.a};
+    fillVertices.push_back({{x, y}, fillColor, {0, 0}});
+    for (const SDL_FPoint& corner : fillCorners) {
+        fillVertices.push_back({{x + corner.x, y + corner.y}, fillColor, {0, 0}});
+    }
+
+    for (const SDL_FPoint& corner : outlineOuterCorners) {
+        outlineVertices.push_back({{x + corner.x, y + corner.y}, outlineColor, {0, 0}});
+    }
+    for (const SDL_FPoint& corner : outlineInnerCorners) {
+        outlineVertices.push_back({{x + corner.x, y + corner.y}, outlineColor, {0, 0}});
+    }
+}
+
+void TerrainRenderer::flush(SDL_Renderer* renderer) {
+    size_t nbHexes = fillVertices.size() / FILL_VERTICES;
+    if (nbHexes > 0) {
+        updateIndices(nbHexes);
+        SDL_RenderGeometry(renderer, nullptr, fillVertices.data(), static_cast<int>(fillVertices.size()), fillIndices.data(), static_cast<int>(nbHexes * FILL_INDICES));
+        SDL_RenderGeometry(renderer, nullptr, outlineVertices.data(), static_cast<int>(outlineVertices.size()), outlineIndices.data(), static_cast<int>(nbHexes * OUTLINE_INDICES));
+    }
+    fillVertices.clear();
+    outlineVertices.clear();
+}
+
+void TerrainRenderer::flushToLayer(SDL_Renderer* renderer) {
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+
+    SDL_SetRenderTarget(renderer, layer);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    flush(renderer);
+
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+    SDL_SetRenderTarget(renderer, previousTarget);
+}
+
+void TerrainRenderer::rebuildLayer(SDL_Renderer* renderer, const HexagonalGrid& grid) {
+    const std::vector<Hex>& hexes = grid.getHexes();
+    Point anchor = grid.hexToPixel(hexes.front());
+    layerValid = true;
+    layerHexSize = grid.getHexSize();
+    layerAnchorX = anchor.x;
+    layerAnchorY = anchor.y;
+    layerOwnersVersion = grid.getOwnersVersion();
+    layerColors.assign(grid.getNbCells(), Color{0, 0, 0, 0});
+    if (layer) {
+        SDL_DestroyTexture(layer);
+        layer = nullptr;
+    }
+
+    // The layer covers the hexes and their outlines
+    double minX = anchor.x, maxX = anchor.x, minY = anchor.y, maxY = anchor.y;
+    for (const auto& hex : hexes) {
+        Point center = grid.hexToPixel(hex);
+        minX = std::min(minX, center.x);
+        maxX = std::max(maxX, center.x);
+        minY = std::min(minY, center.y);
+        maxY = std::max(maxY, center.y);
+    }
+    double margin = layerHexSize + 1;
+    layerX = static_cast<int>(std::floor(minX - margin));
+    layerY = static_cast<int>(std::floor(minY - margin));
+    int width = static_cast<int>(std::ceil(maxX + margin)) - layerX;
+    int height = static_cast<int>(std::ceil(maxY + margin)) - layerY;
+
+    // Start from a transparent layer, the background is seen through the transparent hexes
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!layer || SDL_SetRenderTarget(renderer, layer) != 0) {
+        if (!layerFailureReported) {
+            std::cerr << "Terrain layer unavailable, the grid is drawn directly: " << SDL_GetError() << std::endl;
+            layerFailureReported = true;
+        }
+        if (layer) {
+            SDL_DestroyTexture(layer);
+            layer = nullptr;
+        }
+        return;
+    }
+    SDL_SetTextureBlendMode(layer, SDL_BLENDMODE_BLEND);
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    SDL_SetRenderTarget(renderer, previousTarget);
+
+    for (const auto& hex : hexes) {
+        Point center = grid.hexToPixel(hex);
+        Color& color = layerColors[grid.cellIndex(hex)];
+        color = grid.getHexColor(hex);
+        addHex(static_cast<float>(center.x - layerX), static_cast<float>(center.y - layerY), color);
+    }
+    flushToLayer(renderer);
+}
+
+void TerrainRenderer::repaintChangedHexes(SDL_Renderer* renderer, const HexagonalGrid& grid) {
+    // The grid forgot some of the changes since the layer was painted
+    uint64_t firstVersion = grid.getChangedCellsVersion();
+    if (layerOwnersVersion < firstVersion) {
+        rebuildLayer(renderer, grid);
+        return;
+    }
+
+    // A cell changed several times is painted once, and not at all if it got its color back
+    const std::vector<int>& changedCells = grid.getChangedCells();
+    for (size_t i = layerOwnersVersion - firstVersion; i < changedCells.size(); ++i) {
+        int index = changedCells[i];
+        Hex hex = grid.cellHex(index);
+        Color color = grid.getHexColor(hex);
+        if (!(color == layerColors[index])) {
+            Point center = grid.hexToPixel(hex);
+            layerColors[index] = color;
+            addHex(static_cast<float>(center.x - layerX), static_cast<float>(center.y - layerY), color);
+        }
+    }
+    layerOwnersVersion = grid.getOwnersVersion();
+    flushToLayer(renderer);
+}
+
+void TerrainRenderer::draw(SDL_Renderer* renderer, const HexagonalGrid& grid, const GridView& view) {
+    const std::vector<Hex>& hexes = grid.getHexes();
+    if (hexes.empty()) {
+        return;
+    }
+    updateCorners(grid.getHexSize());
+
+    // Paint the whole layer again after a zoom (or a move of the grid), only the changed hexes after a change of owners
+    Point anchor = grid.hexToPixel(hexes.front());
+    if (!layerValid || grid.getHexSize() != layerHexSize || anchor.x != layerAnchorX || anchor.y != layerAnchorY || static_cast<size_t>(grid.getNbCells()) != layerColors.size()) {
+        rebuildLayer(renderer, grid);
+    } else if (layer && grid.getOwnersVersion() != layerOwnersVersion) {
+        repaintChangedHexes(renderer, grid);
+    }
+
+    if (layer) {
+        // Blit the part of the layer in view
+        int width, height;
+        SDL_QueryTexture(layer, nullptr, nullptr, &width, &height);
+        int left = std::max(layerX, view.x);
+        int top = std::max(layerY, view.y);
+        int right = std::min(layerX + width, view.x + view.width);
+        int bottom = std::min(layerY + height, view.y + view.height);
+        if (left < right && top < bottom) {
+            SDL_Rect sourceRect = {left - layerX, top - layerY, right - left, bottom - top};
+            SDL_Rect viewRect = {left - view.x, top - view.y, right - left, bottom - top};
+            SDL_RenderCopy(renderer, layer, &sourceRect, &viewRect);
+        }
+        return;
+    }
+
+    // No layer: draw the hexes in view, blended with the background like the layer
+    grid.forEachCellInView(view, [&](int index) {
+        Hex hex = grid.cellHex(index);
+        Point center = grid.hexToPixel(hex);
+        addHex(static_cast<float>(center.x - view.x), static_cast<float>(center.y - view.y), grid.getHexColor(hex));
+    });
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    flush(renderer);
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+}
@@ -0,0 +1,74 @@
+#ifndef TERRAINRENDERER_HPP
+#define TERRAINRENDERER_HPP
+
+#include <SDL2/SDL.h>
+#include <array>
+#include <vector>
+
+#include "../core/grid.hpp"
+
+// Draws the hexes of the grid with two batched SDL_RenderGeometry calls, one for the fills and one for the outlines,
+// instead of two software-rasterized polygons per hex. The corners of a hex are computed once per zoom level and
+// the vertex and index buffers are kept from a frame to the next.
+// The hexes are painted once into a terrain layer (a render target covering the map): a frame only blits the layer
+// at the camera position, the layer is painted again when the zoom changes and only the hexes whose owner
+// changed (listed by the grid) are repainted. Without render targets, or if the map is too big for a texture, the hexes in view are drawn directly.
+class TerrainRenderer {
+public:
+    TerrainRenderer() = default;
+    ~TerrainRenderer();
+
+    // The renderer owns a texture, it is not copied
+    TerrainRenderer(const TerrainRenderer& other) = delete;
+    TerrainRenderer& operator=(const TerrainRenderer& other) = delete;
+
+    // Draw the part of the grid seen in a view
+    void draw(SDL_Renderer* renderer, const HexagonalGrid& grid, const GridView& view);
+
+    // Paint the whole terrain layer again at the next frame (e.g. the renderer lost the content of its render targets)
+    void invalidate() { layerValid = false; }
+
+private:
+    // Compute the offsets of the corners from the center of a hex for a hex size
+    void updateCorners(double hexSize);
+
+    // Build the triangles of the fills and outlines of a number of hexes, they only change with the number of hexes
+    void updateIndices(size_t nbHexes);
+
+    // Add the fill and the outline of a hex centered on a point to the buffers
+    void addHex(float x, float y, const Color& color);
+
+    // Submit the buffered hexes, one call for the fills and one for the outlines, and empty the buffers
+    void flush(SDL_Renderer* renderer);
+
+    // Create the terrain layer for the current zoom and paint every hex into it, no layer is kept if the renderer can't
+    void rebuildLayer(SDL_Renderer* renderer, const HexagonalGrid& grid);
+
+    // Paint the hexes whose owner changed since the layer was painted and whose color differs, from the list of changes of the grid
+    void repaintChangedHexes(SDL_Renderer* renderer, const HexagonalGrid& grid);
+
+    // Paint the buffered hexes into the layer, the colors replace the content of the layer (transparency included)
+    void flushToLayer(SDL_Renderer* renderer);
+
+    double cornersHexSize = -1.0;                    // Hex size the corners were computed for
+    std::array<SDL_FPoint, 6> fillCorners;           // Corners of the filled hexagon
+    std::array<SDL_FPoint, 6> outlineOuterCorners;   // Outline, half a pixel out of the hexagon
+    std::array<SDL_FPoint, 6> outlineInnerCorners;   // Outline, half a pixel into the hexagon
+
+    size_t indicesNbHexes = 0;                       // Number of hexes the indices were built for
+    std::vector<SDL_Vertex> fillVertices;            // Center then corners of each hex
+    std::vector<int> fillIndices;
+    std::vector<SDL_Vertex> outlineVertices;         // Outer then inner corners of each hex
+    std::vector<int> outlineIndices;
+
+    SDL_Texture* layer = nullptr;                    // Terrain layer, nullptr if the hexes are drawn directly
+    bool layerValid = false;                         // False when the layer has to be painted again
+    bool layerFailureReported = false;
+    double layerHexSize = -1.0;                      // Hex size and pixel position of the first hex when the layer was painted,
+    double layerAnchorX = 0.0, layerAnchorY = 0.0;   // the layer is painted again when they change
+    int layerX = 0, layerY = 0;                      // Position of the top left corner of the layer, in grid pixels
+    uint64_t layerOwnersVersion = 0;                 // Version of the owners of the grid painted into the layer
+    std::vector<Color> layerColors;                  // Color of each cell of the grid storage in the layer
+};
+
+#endif // TERRAINRENDERER_HPP
@@ -1,10 +1,13 @@
 #include "game/game.hpp"
+#include <algorithm>
 #include <fstream>
+#include <random>
 
 // Function to load both maps from a single file
 bool loadMapsFromFile(const std::string& filename,
                      std::vector<std::string>& asciiMap,
                      std::vector<std::string>& entityMap) {
+    ScopedTrace trace("load map");
     std::ifstream file(filename);
 
     if (!file.is_open()) {
@@ -73,18 +76,57 @@ int main(int argc, char* argv[]) {
     const double hexSize = 30.0;
     const int cameraSpeed = 20;
 
-    const int FPS = 240;
-    const int frameDelay = 1000 / FPS;
+    // While nothing moves on screen the loop sleeps until an event comes, waking up now and then anyway
+    const int idleTimeout = 1000;
 
     // default ASCII and entity maps
     std::vector<std::string> asciiMap;
 
     std::vector<std::string> entityMap;
 
+    // Command line: an optional map file, an optional "--seed <number>" to play the same game again,
+    // an optional "--fps <number>" frame cap (0 for none), "--vsync" to present frames at the refresh rate
+    // and an optional "--trace <file>" to write a timeline of the game to open in chrome://tracing or Perfetto
+    std::string mapFile;
+    std::string traceFile;
+    uint64_t seed = std::random_device{}();
+    int maxFps = 240;
+    bool vsync = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            try {
+                seed = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid seed " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            try {
+                maxFps = std::stoi(argv[++i]);
+            } catch (const std::exception&) {
+                maxFps = -1;
+            }
+            if (maxFps < 0) {
+                std::cerr << "Error: Invalid frame rate " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--vsync") {
+            vsync = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else {
+            mapFile = arg;
+        }
+    }
+    std::cout << "Seed: " << seed << std::endl;
+    if (!traceFile.empty() && !tracer.start(traceFile)) {
+        return 1;
+    }
+
     // Check if a map file is provided as a command-line argument
     std::string defaultMapFile = "maps/1v1_close";
-    if (argc >= 2) {
-        std::string mapFile = argv[1];
+    if (!mapFile.empty()) {
         if (loadMapsFromFile(mapFile, asciiMap, entityMap)) {
             std::cout << "Successfully loaded map from " << mapFile << std::endl;
         } else {
@@ -131,7 +173,11 @@ int main(int argc, char* argv[]) {
     }
 
     // Create the SDL renderer
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (vsync) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer) {
         SDL_Log("Unable to create renderer: %s", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -143,70 +189,98 @@ int main(int argc, char* argv[]) {
     int windowWidth, windowHeight;
     SDL_GetWindowSize(window, &windowWidth, &windowHeight);
 
-    // Create the game instance
-    Game game(hexSize, asciiMap, entityMap, windowWidth, windowHeight, renderer, cameraSpeed);
-
-    Game gamecopy = game;
-    Game gameinit = game;
+    // Create the game instance, undo, redo and replay are handled by the game itself
+    Game game(hexSize, asciiMap, entityMap, seed, windowWidth, windowHeight, renderer, cameraSpeed);
 
-    // Main loop
+    // Main loop: the game is updated at a fixed rate whatever the frame rate, time is measured with the
+    // high resolution counter. A frame is drawn when the game changed or while entities are jumping.
+    const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    const double maxLag = 0.25; // Time caught up after a slow frame at most, the rest is dropped
+    double framePeriod = maxFps > 0 ? 1.0 / maxFps : 0.0;
+    double lag = 0.0;           // Time elapsed but not simulated yet
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
     bool running = true;
     SDL_Event event;
     while (running) {
-        if (game.getTurnButtonClicked()) {
-            gamecopy = game;
-            game.setTurnButtonClicked(false);
-        }
-        if (game.getUndo()) {
-            game = gamecopy;
-            game.setUndo(false);
-        }
-        if (game.getReplayButtonClicked()) {
-            game = gameinit;
-            gamecopy = gameinit;
-            game.setReplayButtonClicked(false);
-            game.setEndGame(false);
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        bool hasEvent;
+        if (game.needsRedraw() || game.isAnimating()) {
+            hasEvent = SDL_PollEvent(&event);
+        } else {
+            hasEvent = SDL_WaitEventTimeout(&event, idleTimeout);
         }
-        Uint32 frameStart = SDL_GetTicks();
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_KEYDOWN) {
-                if (event.key.keysym.sym == SDLK_DELETE) {
-                    running = false;
-                } else if (event.key.keysym.sym == SDLK_e) {
+
+        // The profiler times the iterations that draw a frame, from their first event to the present:
+        // the time spent waiting idle and the frame cap are not part of a frame
+        {
+            ScopedTimer frameTimer(ProfilePhase::Frame);
+            {
+                ScopedTimer timer(ProfilePhase::Events);
+                while (hasEvent) {
+                    if (event.type == SDL_KEYDOWN) {
+                        if (event.key.keysym.sym == SDLK_DELETE) {
+                            running = false;
+                        }
+                    } else if (event.type == SDL_QUIT) {
+                        running = false;
+                    }
                     game.handleEvent(event);
-                    gamecopy = game;
-                    continue;
-                } else if (event.key.keysym.sym == SDLK_BACKSPACE || event.key.keysym.sym == SDLK_r) {
-                    game = gamecopy;
+                    if(game.getEndGame()) {
+                        running = false;
+                    }
+                    hasEvent = SDL_PollEvent(&event);
                 }
-            } else if (event.type == SDL_QUIT) {
-                running = false;
-            }
-            game.handleEvent(event);
-            if(game.getEndGame()) {
-                running = false;
             }
-        }
 
-        game.update();
+            // Simulate the time elapsed in fixed steps. Time spent idle is not caught up: a single update
+            // runs at once, which starts the animations of the events just handled.
+            Uint64 counter = SDL_GetPerformanceCounter();
+            lag += static_cast<double>(counter - previousCounter) / counterFrequency;
+            previousCounter = counter;
+            if (!game.isAnimating()) {
+                lag = Game::UPDATE_STEP;
+            }
+            lag = std::min(lag, maxLag);
+            {
+                ScopedTimer timer(ProfilePhase::Update);
+                while (lag >= Game::UPDATE_STEP) {
+                    game.update();
+                    lag -= Game::UPDATE_STEP;
+                }
+            }
+            if (!game.needsRedraw() && !game.isAnimating()) {
+                frameTimer.cancel();
+                continue;
+            }
 
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 119, 182, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(renderer);
+            // Clear the screen
+            SDL_SetRenderDrawColor(renderer, 0, 119, 182, SDL_ALPHA_OPAQUE);
+            SDL_RenderClear(renderer);
 
-        // Render the game
-        game.renderAll(renderer);
+            // Render the game between the last two updates
+            game.renderAll(renderer, static_cast<float>(lag / Game::UPDATE_STEP));
+            game.markDrawn();
 
-        // Present the rendered frame
-        SDL_RenderPresent(renderer);
+            // Present the rendered frame
+            {
+                ScopedTimer timer(ProfilePhase::Present);
+                SDL_RenderPresent(renderer);
+            }
+        }
 
         // Cap the frame rate
-        Uint32 frameTime = SDL_GetTicks() - frameStart;
-        if (frameDelay > frameTime) {
-            SDL_Delay(frameDelay - frameTime);
+        double frameTime = static_cast<double>(SDL_GetPerformanceCounter() - frameStart) / counterFrequency;
+        if (framePeriod > frameTime) {
+            SDL_Delay(static_cast<Uint32>((framePeriod - frameTime) * 1000));
         }
     }
 
+    // The events recorded since the start are written at exit
+    if (tracer.isEnabled()) {
+        tracer.finish();
+        std::cout << "Trace written to " << traceFile << std::endl;
+    }
+
     // Clean up
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
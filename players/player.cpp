@@ -1,19 +1,80 @@
 #include "player.hpp"
 
-Player::Player(SDL_Color color) : color(color) {
+Player::Player(OwnerId owner) : owner(owner) {
     coins = 10;
     townDestroyed = false;
     alive = true;
+    journal = nullptr;
 }
 
-void Player::addEntity(std::shared_ptr<Entity> entity) {
+void Player::record(JournalField field, int index, int64_t value, EntityHandle entity) {
+    if (journal) {
+        journal->record({field, owner, index, value, entity.toBits()});
+    }
+}
+
+void Player::addEntity(EntityHandle entity) {
+    record(JournalField::PlayerEntityAdded, static_cast<int>(entities.size()), 0, entity);
     entities.push_back(entity);
 }
 
-void Player::removeEntity(std::shared_ptr<Entity> entity) {
+void Player::removeEntity(EntityHandle entity) {
     // Using STL algorithm to find and remove the entity
     auto it = std::find(entities.begin(), entities.end(), entity);
     if (it != entities.end()) {
+        record(JournalField::PlayerEntityRemoved, static_cast<int>(it - entities.begin()), 0, entity);
         entities.erase(it);
     }
 }
+
+void Player::removeEntities(const std::vector<EntityHandle>& removed) {
+    removeEntitiesFromList(entities, removed, [&](int position, EntityHandle entity) {
+        record(JournalField::PlayerEntityRemoved, position, 0, entity);
+    });
+}
+
+void Player::addCoins(int amount) {
+    record(JournalField::PlayerCoins, 0, coins);
+    coins += amount;
+}
+
+void Player::setTownDestroyed(bool destroyed) {
+    record(JournalField::PlayerTownDestroyed, 0, townDestroyed);
+    townDestroyed = destroyed;
+}
+
+void Player::setAlive(bool alive) {
+    record(JournalField::PlayerAlive, 0, this->alive);
+    this->alive = alive;
+}
+
+void Player::applyJournalEntry(JournalEntry& entry) {
+    int64_t current;
+    switch (entry.field) {
+        case JournalField::PlayerCoins:
+            current = coins;
+            coins = static_cast<int>(entry.value);
+            entry.value = current;
+            break;
+        case JournalField::PlayerTownDestroyed:
+            current = townDestroyed;
+            townDestroyed = entry.value != 0;
+            entry.value = current;
+            break;
+        case JournalField::PlayerAlive:
+            current = alive;
+            alive = entry.value != 0;
+            entry.value = current;
+            break;
+        case JournalField::PlayerEntityAdded:
+            entities.erase(entities.begin() + entry.index);
+            entry.field = JournalField::PlayerEntityRemoved;
+            break;
+        case JournalField::PlayerEntityRemoved:
+            entities.insert(entities.begin() + entry.index, EntityHandle::fromBits(entry.entity));
+            entry.field = JournalField::PlayerEntityAdded;
+            break;
+        default:
+            throw std::invalid_argument("Not a player journal entry");
+    }
+}
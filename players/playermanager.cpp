@@ -1,140 +1,150 @@
 #include "playermanager.hpp"
+#include "../core/trace.hpp"
 
-// Check if a hex is surrounded other entities of the same player
-std::string PlayerManager::hasSamePlayerEntities(const Hex& hex, const Player& currentPlayer) const {
-    for (const auto& entity : currentPlayer.getEntities()) {
-        if (entity->getHex() == hex) {
-            return entity->getName();
-        }
+// Kind of the entity of the same player standing on a hex, EntityKind::None if there is none
+EntityKind PlayerManager::hasSamePlayerEntities(const Hex& hex, const Player& currentPlayer, const HexagonalGrid& grid) const {
+    const HexOccupant& occupant = grid.getOccupant(hex);
+    if (occupant.owner == currentPlayer.getOwner()) {
+        return occupant.kind;
     }
-    return "";
+    return EntityKind::None;
 }
 
-void PlayerManager::removePlayer(std::shared_ptr<Player> player, int& nbplayers, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps) {
-    auto entities = player->getEntities();
-    // vector "toRemove" to store the entities to remove to avoid modifying the vector while iterating over it
-    std::vector<std::shared_ptr<Entity>> toRemove;
-    for(auto& entity : entities) {
-        if (entity) {
-            if (dynamic_cast<Building*>(entity.get())) {
-                entityManager.addBanditCamp(entity->getHex(), banditCamps);
-            } else {
-                entityManager.addBandit(entity->getHex(), bandits);
-            }
-            toRemove.push_back(entity);
+void PlayerManager::removePlayer(std::shared_ptr<Player> player, int& nbplayers, HexagonalGrid& grid, GameEntities& gameEntities) {
+    ScopedTrace trace("remove dead player");
+    // Copy of the entities to avoid modifying the vector while iterating over it
+    std::vector<EntityHandle> entities = player->getEntities();
+    for(EntityHandle entity : entities) {
+        Hex hex = gameEntities.store.getHex(entity);
+        bool isBuilding = gameEntities.store.isBuilding(entity);
+        entityManager.removeEntity(grid, gameEntities, entity);
+        if (isBuilding) {
+            entityManager.addNeutralEntity(grid, gameEntities, EntityKind::BanditCamp, hex);
+            // The territory around a lost town has to be checked again
+            grid.markDirty(hex);
+        } else {
+            entityManager.addNeutralEntity(grid, gameEntities, EntityKind::Bandit, hex);
         }
     }
-    for(auto& entity : toRemove) {
-        player->removeEntity(entity);
-    }
 
     player->setAlive(false);
     nbplayers--;
 }
 
-void PlayerManager::checkIfHexConnectedToTown(Player& player, HexagonalGrid& grid, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps) {
-    // Get the player's color and original color
-    SDL_Color playerColor = player.getColor();
-    SDL_Color originalColor = playerColor;
-    
-    // Find all hexes with this player's color or darker versions of it
-    std::vector<Hex> playerHexes;
-    std::map<Hex, SDL_Color> currentHexColors; // Store current colors for potential restoration
-    
-    for (const auto& pair : grid.getHexColors()) {
-        const SDL_Color& hexColor = pair.second;
-        // Check if this is the player's color or a darker version of it (not sure about how clean the > * 0.69 is, but it works)
-        if (hexColor == playerColor || 
-            (hexColor.r <= playerColor.r && hexColor.g <= playerColor.g && 
-             hexColor.b <= playerColor.b && 
-             hexColor.r >= playerColor.r * 0.69 && hexColor.g >= playerColor.g * 0.69 && 
-             hexColor.b >= playerColor.b * 0.69)) {
-            
-            playerHexes.push_back(pair.first);
-            currentHexColors[pair.first] = hexColor;
-        }
+// Only the territories touching a dirty cell (owner change or lost town) are flooded again:
+// each of them is either connected to one of its owner's towns or entirely disconnected.
+void PlayerManager::updateTerritoryConnectivity(HexagonalGrid& grid, GameEntities& gameEntities) {
+    ScopedTrace trace("connectivity");
+    const std::vector<std::shared_ptr<Player>>& players = gameEntities.players;
+
+    // Each flooded territory gets its own epoch, cells stamped after updateStart were flooded during this update
+    if (visited.size() != static_cast<size_t>(grid.getNbCells()) || visitEpoch > std::numeric_limits<unsigned>::max() - visited.size()) {
+        visited.assign(grid.getNbCells(), 0);
+        visitEpoch = 0;
     }
-    
-    // Find all town hexes
-    std::vector<Hex> townHexes;
-    for (const auto& entity : player.getEntities()) {
-        if (entity->getName() == "town") {
-            townHexes.push_back(entity->getHex());
+    unsigned updateStart = visitEpoch;
+
+    // Town hexes of each owner, only gathered for the owners whose territory is flooded
+    std::vector<std::vector<int>> townCells(players.size() + 1);
+    std::vector<bool> townsGathered(players.size() + 1, false);
+
+    // Disconnected cells of each owner
+    std::vector<std::vector<int>> disconnectedCells(players.size() + 1);
+
+    std::vector<int> component;
+    for (int dirtyCell : grid.getDirtyCells()) {
+        // The owner of the cell may have gained a territory, the previous owner may have been split around it
+        const int* neighbors = grid.cellNeighbors(dirtyCell);
+        int seeds[NB_DIRECTIONS + 1];
+        int nbSeeds = 0;
+        seeds[nbSeeds++] = dirtyCell;
+        for (int d = 0; d < NB_DIRECTIONS; ++d) {
+            if (neighbors[d] != -1) {
+                seeds[nbSeeds++] = neighbors[d];
+            }
         }
-    }
-    
-    // If no towns, all hexes are disconnected
-    if (townHexes.empty()) {
-        for (const Hex& hex : playerHexes) {
-            disconnectHex(player, hex, grid, bandits, banditCamps);
+
+        for (int i = 0; i < nbSeeds; ++i) {
+            int seed = seeds[i];
+            OwnerId owner = grid.getCellOwner(seed);
+            if (owner == NEUTRAL_OWNER || visited[seed] > updateStart) {
+                continue;
+            }
+
+            if (!townsGathered[owner]) {
+                for (EntityHandle entity : players[owner - 1]->getEntities()) {
+                    if (gameEntities.store.getKind(entity) == EntityKind::Town) {
+                        townCells[owner].push_back(grid.cellIndex(gameEntities.store.getHex(entity)));
+                    }
+                }
+                townsGathered[owner] = true;
+            }
+
+            component.clear();
+            floodTerritory(grid, seed, component);
+
+            bool connected = false;
+            for (int townCell : townCells[owner]) {
+                if (townCell != -1 && visited[townCell] == visitEpoch) {
+                    connected = true;
+                    break;
+                }
+            }
+
+            if (connected) {
+                // Connect the whole territory again
+                for (int cell : component) {
+                    grid.setDisconnected(grid.cellHex(cell), false);
+                }
+            } else {
+                disconnectedCells[owner].insert(disconnectedCells[owner].end(), component.begin(), component.end());
+            }
         }
-        return;
     }
-    
-    // Use BFS to find all hexes connected to any town
-    std::set<Hex> connectedHexes;
-    std::queue<Hex> queue;
-    
-    // Start BFS from each town
-    for (const Hex& townHex : townHexes) {
-        queue.push(townHex);
-        connectedHexes.insert(townHex);
-    }
-    
-    // BFS traversal
-    while (!queue.empty()) {
-        Hex current = queue.front();
-        queue.pop();
-        
-        // If current hex has a darker color, restore it to the player's original color
-        if (!(grid.getHexColors().at(current) == playerColor)) {
-            grid.setHexColor(current, originalColor);
-        }
-        
-        // Check all adjacent hexes
-        for (const Hex& dir : directions) {
-            Hex neighbor = current.add(dir);
-            
-            // If neighbor exists and has any version of player's color (original or darker)
-            if (grid.hexExists(neighbor) && 
-                currentHexColors.find(neighbor) != currentHexColors.end() &&
-                connectedHexes.find(neighbor) == connectedHexes.end()) {
-                
-                connectedHexes.insert(neighbor);
-                queue.push(neighbor);
-            }
+    grid.clearDirtyCells();
+
+    // Handle disconnected hexes, player by player in grid order
+    for (size_t owner = 1; owner < disconnectedCells.size(); ++owner) {
+        std::sort(disconnectedCells[owner].begin(), disconnectedCells[owner].end());
+        for (int cell : disconnectedCells[owner]) {
+            disconnectHex(*players[owner - 1], grid.cellHex(cell), grid, gameEntities);
         }
     }
-    
-    // Handle disconnected hexes
-    for (const Hex& hex : playerHexes) {
-        if (connectedHexes.find(hex) == connectedHexes.end()) {
-            disconnectHex(player, hex, grid, bandits, banditCamps);
+}
+
+void PlayerManager::floodTerritory(const HexagonalGrid& grid, int startCell, std::vector<int>& component) {
+    OwnerId owner = grid.getCellOwner(startCell);
+
+    // BFS over the hexes of the owner, connected or not
+    visitEpoch++;
+    visited[startCell] = visitEpoch;
+    component.push_back(startCell);
+    for (size_t i = 0; i < component.size(); ++i) {
+        const int* neighbors = grid.cellNeighbors(component[i]);
+        for (int d = 0; d < NB_DIRECTIONS; ++d) {
+            int neighbor = neighbors[d];
+            if (neighbor != -1 && visited[neighbor] != visitEpoch && grid.getCellOwner(neighbor) == owner) {
+                visited[neighbor] = visitEpoch;
+                component.push_back(neighbor);
+            }
         }
     }
 }
 
 
-void PlayerManager::disconnectHex(Player& player, const Hex& hex, HexagonalGrid& grid, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps) {
-    // Make the color darker
-    SDL_Color newHexColor = player.getColor();
-    newHexColor.r = newHexColor.r * 0.7;
-    newHexColor.g = newHexColor.g * 0.7;
-    newHexColor.b = newHexColor.b * 0.7;
-    grid.setHexColor(hex, newHexColor);
+void PlayerManager::disconnectHex(Player& player, const Hex& hex, HexagonalGrid& grid, GameEntities& gameEntities) {
+    // Flag the hex as cut from the player's towns
+    grid.setDisconnected(hex, true);
     
     // Remove potential entity on this hex and replace with bandits
-    std::vector<std::shared_ptr<Entity>> entitiesToRemove;
-    
-    for (auto& entity : player.getEntities()) {
-        if (entity->getHex() == hex) {
-            if (dynamic_cast<Building*>(entity.get())) {
-                entityManager.addBanditCamp(hex, banditCamps);
-            } else {
-                entityManager.addBandit(hex, bandits);
-            }
-            player.removeEntity(entity);
-            break;
-        }
+    const HexOccupant occupant = grid.getOccupant(hex);
+    if (occupant.owner != player.getOwner()) {
+        return;
+    }
+    entityManager.removeEntity(grid, gameEntities, occupant.entity);
+    if (entityTraits(occupant.kind).building) {
+        entityManager.addNeutralEntity(grid, gameEntities, EntityKind::BanditCamp, hex);
+    } else {
+        entityManager.addNeutralEntity(grid, gameEntities, EntityKind::Bandit, hex);
     }
 }
\ No newline at end of file
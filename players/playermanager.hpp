@@ -1,19 +1,19 @@
 #ifndef PLAYERMANAGER_HPP
 #define PLAYERMANAGER_HPP
 
-#include <queue>
-#include <set>
-
 #include "../entities/entitymanager.hpp"
 
 class PlayerManager {
 public:
-    std::string hasSamePlayerEntities(const Hex& hex, const Player& currentPlayer) const;
-    void removePlayer(std::shared_ptr<Player> player, int& nbplayers, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps);
-    void checkIfHexConnectedToTown(Player& player, HexagonalGrid& grid, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps);
+    EntityKind hasSamePlayerEntities(const Hex& hex, const Player& currentPlayer, const HexagonalGrid& grid) const;
+    void removePlayer(std::shared_ptr<Player> player, int& nbplayers, HexagonalGrid& grid, GameEntities& gameEntities);
+    void updateTerritoryConnectivity(HexagonalGrid& grid, GameEntities& gameEntities);
 private:
-    void disconnectHex(Player& player, const Hex& hex, HexagonalGrid& grid, std::vector<std::shared_ptr<Bandit>>& bandits, std::vector<std::shared_ptr<BanditCamp>>& banditCamps);
-    EntityManager entityManager;  
+    void disconnectHex(Player& player, const Hex& hex, HexagonalGrid& grid, GameEntities& gameEntities);
+    void floodTerritory(const HexagonalGrid& grid, int startCell, std::vector<int>& component);
+    EntityManager entityManager;
+    std::vector<unsigned> visited; // Flood epoch of each cell, avoids clearing the whole array at each update
+    unsigned visitEpoch = 0;
 };
 
 #endif // PLAYERMANAGER_HPP
\ No newline at end of file
@@ -5,10 +5,13 @@
 #include <string>
 #include <functional>
 
+#include "../constants/icons.hpp"
+
 class Button {
 private:
     SDL_Rect rect;
     std::string iconName;
+    Icon icon;          // Icon of the name, looked up once
     int cost;
 
 public:
@@ -18,6 +21,7 @@ public:
     
     SDL_Rect getRect() const { return rect; }
     std::string getIconName() const { return iconName; }
+    Icon getIcon() const { return icon; }
     int getCost() const { return cost; }
 };
 
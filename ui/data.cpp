@@ -1,39 +1,24 @@
 #include "data.hpp"
 
-void RenderData::renderImageWithText(const SDL_Rect& imageRect, const std::string& iconKey, const std::string& text) {
-    // Check if the iconKey exists in iconNames
-    if (getIconIndex(iconKey) == -1) {
-        std::cerr << "Error: Icon key not found in iconNames" << std::endl;
-        return;
-    }
-
-    // Get the texture index from the iconNames
-    int textureIndex = getIconIndex(iconKey);
-
+void RenderData::renderImageWithText(const SDL_Rect& imageRect, Icon icon, const std::string& text) {
     // Render the image
-    SDL_RenderCopy(renderer, textures[textureIndex], NULL, &imageRect);
+    icons.draw(renderer, icon, imageRect);
 
-    // Create the text surface and texture
+    // Get the texture of the text, rendered the first time it is shown
     SDL_Color textColor = {255, 255, 255, 255};
-    std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)> textSurface(
-        TTF_RenderText_Solid(font, text.c_str(), textColor),
-        &SDL_FreeSurface
-    );
-
-    std::shared_ptr<SDL_Texture> textTexture(
-        SDL_CreateTextureFromSurface(renderer, textSurface.get()),
-        SDL_DestroyTexture
-    );
+    int textWidth, textHeight;
+    SDL_Texture* textTexture = textCache.getText(renderer, fontSize, textColor, text, textWidth, textHeight);
+    if (!textTexture) {
+        return;
+    }
 
     // Calculate the text rectangle position
     SDL_Rect textRect;
     textRect.x = imageRect.x + imageRect.w + 10;
     textRect.h = 30;
     textRect.y = imageRect.y + (imageRect.h - textRect.h) / 2; // Center the text vertically
-
-    // Calculate the width of the text
-    SDL_QueryTexture(textTexture.get(), NULL, NULL, &textRect.w, NULL);
+    textRect.w = textWidth;
 
     // Render the text
-    SDL_RenderCopy(renderer, textTexture.get(), NULL, &textRect);
+    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
 }
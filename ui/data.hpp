@@ -2,22 +2,28 @@
 #define DATA_HPP
 
 #include <SDL2/SDL_ttf.h>
+#include <iostream>
+#include <memory>
+#include <vector>
 
-#include "../constants/constants.hpp"
+#include "icons.hpp"
+#include "textcache.hpp"
 
 class RenderData {
 public:
     RenderData(SDL_Renderer* renderer,
-               TTF_Font* font,
-               const std::vector<SDL_Texture*>& textures)
-        : renderer(renderer), font(font), textures(textures) {}
+               TextCache& textCache,
+               int fontSize,
+               const IconAtlas& icons)
+        : renderer(renderer), textCache(textCache), fontSize(fontSize), icons(icons) {}
 
-    void renderImageWithText(const SDL_Rect& imageRect, const std::string& iconKey, const std::string& text);
+    void renderImageWithText(const SDL_Rect& imageRect, Icon icon, const std::string& text);
 
 private:
     SDL_Renderer* renderer;
-    TTF_Font* font;
-    const std::vector<SDL_Texture*>& textures;
+    TextCache& textCache;
+    int fontSize;
+    const IconAtlas& icons;
 };
 
 #endif // DATA_HPP
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "icons.hpp"
+#include "../core/trace.hpp"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <iostream>
+
+// Width of the atlas the icons are packed into, and space around them so that scaled icons don't bleed into their neighbors
+static const int ATLAS_MAX_WIDTH = 2048;
+static const int ATLAS_PADDING = 2;
+
+IconAtlas::~IconAtlas() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+    }
+}
+
+bool IconAtlas::load(SDL_Renderer* renderer, const std::string& directory) {
+    ScopedTrace trace("load icons");
+    std::array<SDL_Surface*, NB_ICONS> surfaces;
+    for (int i = 0; i < NB_ICONS; ++i) {
+        std::string path = directory + iconNames[i] + ".png";
+        surfaces[i] = IMG_Load(path.c_str());
+        if (!surfaces[i]) {
+            std::cerr << "Error loading texture: " << IMG_GetError() << std::endl;
+        }
+    }
+
+    // Pack the icons in rows, the tallest first so that the rows are filled evenly
+    std::array<int, NB_ICONS> order;
+    for (int i = 0; i < NB_ICONS; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return (surfaces[a] ? surfaces[a]->h : 0) > (surfaces[b] ? surfaces[b]->h : 0);
+    });
+    int x = 0, y = 0, rowHeight = 0, atlasWidth = 0;
+    iconRects.fill({0, 0, 0, 0});
+    for (int i : order) {
+        if (!surfaces[i]) {
+            continue;
+        }
+        if (x > 0 && x + surfaces[i]->w > ATLAS_MAX_WIDTH) {
+            x = 0;
+            y += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        iconRects[i] = {x, y, surfaces[i]->w, surfaces[i]->h};
+        x += surfaces[i]->w + ATLAS_PADDING;
+        rowHeight = std::max(rowHeight, surfaces[i]->h);
+        atlasWidth = std::max(atlasWidth, x);
+    }
+    int atlasHeight = y + rowHeight;
+
+    // Copy the icons into the atlas as they are, transparency included
+    SDL_Surface* atlas = nullptr;
+    if (atlasWidth > 0 && atlasHeight > 0) {
+        atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    }
+    for (int i = 0; i < NB_ICONS; ++i) {
+        if (surfaces[i]) {
+            if (atlas) {
+                SDL_Rect iconRect = iconRects[i];
+                SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(surfaces[i], nullptr, atlas, &iconRect);
+            }
+            SDL_FreeSurface(surfaces[i]);
+        }
+    }
+    if (!atlas) {
+        std::cerr << "Error creating the icon atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    if (texture) {
+        SDL_DestroyTexture(texture);
+    }
+    texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_FreeSurface(atlas);
+    if (!texture) {
+        std::cerr << "Error creating the icon atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void IconAtlas::draw(SDL_Renderer* renderer, Icon icon, const SDL_Rect& rect) const {
+    if (icon == Icon::None || !texture) {
+        return;
+    }
+    const SDL_Rect& iconRect = iconRects[static_cast<size_t>(icon)];
+    if (iconRect.w > 0) {
+        SDL_RenderCopy(renderer, texture, &iconRect, &rect);
+    }
+}
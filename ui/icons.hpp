@@ -0,0 +1,31 @@
+#ifndef ICONS_HPP
+#define ICONS_HPP
+
+#include <SDL2/SDL.h>
+#include <string>
+
+#include "../constants/icons.hpp"
+
+// Every icon of the game packed into one texture when the game starts: drawing an icon is a copy of a part
+// of the atlas, copies sharing a texture are batched by the renderer.
+class IconAtlas {
+public:
+    IconAtlas() = default;
+    ~IconAtlas();
+
+    // The atlas owns a texture, it is not copied
+    IconAtlas(const IconAtlas& other) = delete;
+    IconAtlas& operator=(const IconAtlas& other) = delete;
+
+    // Load the icons of a directory (one PNG file per name of iconNames) and pack them, false if the atlas can't be created
+    bool load(SDL_Renderer* renderer, const std::string& directory);
+
+    // Draw an icon stretched to a rectangle, nothing is drawn if the icon was not loaded
+    void draw(SDL_Renderer* renderer, Icon icon, const SDL_Rect& rect) const;
+
+private:
+    SDL_Texture* texture = nullptr;
+    std::array<SDL_Rect, NB_ICONS> iconRects = {}; // Part of the atlas holding each icon, empty if it was not loaded
+};
+
+#endif // ICONS_HPP
@@ -0,0 +1,79 @@
+#include "textcache.hpp"
+#include "../core/trace.hpp"
+#include <iostream>
+
+static const char* fontPath = "assets/OpenSans.ttf";
+
+TextCache::~TextCache() {
+    clear();
+    for (auto& font : fonts) {
+        if (font.second) {
+            TTF_CloseFont(font.second);
+        }
+    }
+}
+
+TTF_Font* TextCache::getFont(int size) {
+    auto font = fonts.find(size);
+    if (font != fonts.end()) {
+        return font->second;
+    }
+
+    // A font that can't be opened is not tried again
+    ScopedTrace trace("open font");
+    TTF_Font* opened = TTF_OpenFont(fontPath, size);
+    if (!opened) {
+        std::cerr << "Error loading font: " << TTF_GetError() << std::endl;
+    }
+    fonts[size] = opened;
+    return opened;
+}
+
+SDL_Texture* TextCache::getText(SDL_Renderer* renderer, int fontSize, SDL_Color color, const std::string& text, int& width, int& height) {
+    std::string key = std::to_string(fontSize) + ' ' + std::to_string(color.r) + ' ' + std::to_string(color.g) + ' '
+        + std::to_string(color.b) + ' ' + std::to_string(color.a) + ' ' + text;
+
+    // A text already rendered moves to the front of the list
+    auto found = textKeys.find(key);
+    if (found != textKeys.end()) {
+        texts.splice(texts.begin(), texts, found->second);
+        width = found->second->width;
+        height = found->second->height;
+        return found->second->texture;
+    }
+
+    ScopedTrace trace("render text");
+    TTF_Font* font = getFont(fontSize);
+    if (!font) {
+        return nullptr;
+    }
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
+    if (!surface) {
+        return nullptr;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    width = surface->w;
+    height = surface->h;
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        return nullptr;
+    }
+
+    // Drop the least recently shown text to make room
+    if (texts.size() >= capacity) {
+        SDL_DestroyTexture(texts.back().texture);
+        textKeys.erase(texts.back().key);
+        texts.pop_back();
+    }
+    texts.push_front({key, texture, width, height});
+    textKeys[key] = texts.begin();
+    return texture;
+}
+
+void TextCache::clear() {
+    for (Text& text : texts) {
+        SDL_DestroyTexture(text.texture);
+    }
+    texts.clear();
+    textKeys.clear();
+}
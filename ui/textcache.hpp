@@ -0,0 +1,45 @@
+#ifndef TEXTCACHE_HPP
+#define TEXTCACHE_HPP
+
+#include <SDL2/SDL_ttf.h>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// Font of the game at each size, opened once, and textures of the texts rendered with them.
+// The HUD shows the same few strings frame after frame: a text is rendered and uploaded the first time
+// it is shown, the least recently shown texts are dropped when there are more than the capacity.
+class TextCache {
+public:
+    explicit TextCache(size_t capacity = 64) : capacity(capacity) {}
+    ~TextCache();
+
+    // The cache owns fonts and textures, it is not copied
+    TextCache(const TextCache& other) = delete;
+    TextCache& operator=(const TextCache& other) = delete;
+
+    // Font of the game at a size, opened at the first use, nullptr if it can't be opened
+    TTF_Font* getFont(int size);
+
+    // Texture of a text written with the font of a size in a color, and its size in pixels, nullptr if it can't be rendered.
+    // The texture belongs to the cache and stays valid until the text is dropped: use it for the current frame only.
+    SDL_Texture* getText(SDL_Renderer* renderer, int fontSize, SDL_Color color, const std::string& text, int& width, int& height);
+
+    // Destroy the textures of the texts (e.g. the renderer lost its textures), the fonts are kept
+    void clear();
+
+private:
+    struct Text {
+        std::string key;
+        SDL_Texture* texture;
+        int width, height;
+    };
+
+    size_t capacity;
+    std::map<int, TTF_Font*> fonts;                                      // Font of each size, nullptr if it can't be opened
+    std::list<Text> texts;                                               // Most recently shown first
+    std::unordered_map<std::string, std::list<Text>::iterator> textKeys; // Text of each key (size, color and string)
+};
+
+#endif // TEXTCACHE_HPP